@@ -0,0 +1,11 @@
+uniform sampler2D textureUnit;
+
+in vec2 v_uv;
+in vec4 v_color;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture( textureUnit, v_uv ) * v_color;
+}
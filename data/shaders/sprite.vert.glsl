@@ -0,0 +1,22 @@
+layout (location = 0) in vec2 corner;
+layout (location = 1) in vec4 positionRotation;
+layout (location = 2) in vec4 sizeUVOffset;
+layout (location = 3) in vec2 uvSize;
+layout (location = 4) in vec4 color;
+
+uniform mat4 modelViewMatrix;
+
+out vec2 v_uv;
+out vec4 v_color;
+
+void main()
+{
+    vec2 c = corner * sizeUVOffset.xy;
+    float s = sin(positionRotation.w);
+    float co = cos(positionRotation.w);
+    vec2 offset = vec2(c.x * co - c.y * s, c.x * s + c.y * co);
+
+    v_uv = sizeUVOffset.zw + vec2(corner.x + 0.5, 0.5 - corner.y) * uvSize;
+    v_color = color;
+    gl_Position = modelViewMatrix * vec4(positionRotation.xyz + vec3(offset, 0.0), 1.0);
+}
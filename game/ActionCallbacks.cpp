@@ -23,14 +23,16 @@
 #include <Direction.hpp>
 #include <Camera.hpp>
 #include <MenuManager.hpp>
+#include <SimThread.hpp>
+#include <RenderSnapshot.hpp>
 #include <ActionCallbacks.hpp>
 #include <Audio.hpp>
 
-void TapAction::performAction(Trigger&, bool isDown) {
+void TapAction::performAction(Trigger& trigger, bool isDown) {
     //    XTRACE();
     switch (GameState::context) {
         case Context::eInGame:
-            HeroS::instance()->tap(isDown);
+            HeroS::instance()->tap(isDown, trigger.time);
             break;
         default:
             break;
@@ -41,7 +43,7 @@ void MotionAction::performAction(Trigger& trigger, bool /*isDown*/) {
     //    XTRACE();
     switch (GameState::context) {
         case Context::eInGame:
-            HeroS::instance()->move(trigger.fData1, trigger.fData2);
+            HeroS::instance()->move(trigger.fData1, trigger.fData2, trigger.time);
             break;
         case Context::eCameraFlyby:
             CameraS::instance()->mouseLook(trigger.fData1, trigger.fData2);
@@ -51,11 +53,11 @@ void MotionAction::performAction(Trigger& trigger, bool /*isDown*/) {
     }
 }
 
-void MotionLeftAction::performAction(Trigger&, bool isDown) {
+void MotionLeftAction::performAction(Trigger& trigger, bool isDown) {
     //    XTRACE();
     switch (GameState::context) {
         case Context::eInGame:
-            HeroS::instance()->applyDirection(Direction::eLeft, isDown);
+            HeroS::instance()->applyDirection(Direction::eLeft, isDown, trigger.time);
             break;
         case Context::eCameraFlyby:
             CameraS::instance()->move(Direction::eLeft, isDown);
@@ -65,11 +67,11 @@ void MotionLeftAction::performAction(Trigger&, bool isDown) {
     }
 }
 
-void MotionRightAction::performAction(Trigger&, bool isDown) {
+void MotionRightAction::performAction(Trigger& trigger, bool isDown) {
     //    XTRACE();
     switch (GameState::context) {
         case Context::eInGame:
-            HeroS::instance()->applyDirection(Direction::eRight, isDown);
+            HeroS::instance()->applyDirection(Direction::eRight, isDown, trigger.time);
             break;
         case Context::eCameraFlyby:
             CameraS::instance()->move(Direction::eRight, isDown);
@@ -79,11 +81,11 @@ void MotionRightAction::performAction(Trigger&, bool isDown) {
     }
 }
 
-void MotionUpAction::performAction(Trigger&, bool isDown) {
+void MotionUpAction::performAction(Trigger& trigger, bool isDown) {
     //    XTRACE();
     switch (GameState::context) {
         case Context::eInGame:
-            HeroS::instance()->applyDirection(Direction::eUp, isDown);
+            HeroS::instance()->applyDirection(Direction::eUp, isDown, trigger.time);
             break;
         case Context::eCameraFlyby:
             CameraS::instance()->move(Direction::eUp, isDown);
@@ -93,11 +95,11 @@ void MotionUpAction::performAction(Trigger&, bool isDown) {
     }
 }
 
-void MotionDownAction::performAction(Trigger&, bool isDown) {
+void MotionDownAction::performAction(Trigger& trigger, bool isDown) {
     //    XTRACE();
     switch (GameState::context) {
         case Context::eInGame:
-            HeroS::instance()->applyDirection(Direction::eDown, isDown);
+            HeroS::instance()->applyDirection(Direction::eDown, isDown, trigger.time);
             break;
         case Context::eCameraFlyby:
             CameraS::instance()->move(Direction::eDown, isDown);
@@ -139,10 +141,12 @@ void ChangeContext::performAction(Trigger&, bool isDown) {
         return;
     }
 
+    WorldLock lock;
     if (GameState::context == Context::eInGame) {
         LOG_INFO << "eCameraFlyby..." << endl;
         GameState::context = Context::eCameraFlyby;
         GameState::stopwatch.pause();
+        HeroS::instance()->discardInput();
     } else if (GameState::context == Context::eCameraFlyby) {
         LOG_INFO << "eInGame..." << endl;
         GameState::context = Context::eInGame;
@@ -157,7 +161,7 @@ void CritterBoard::performAction(Trigger& t, bool isDown) {
     }
 
     //    LOG_INFO << "toggle CritterBoard..." << endl;
-    if (HeroS::instance()->alive()) {
+    if (SnapshotBufferS::instance()->current().hero.alive) {
         GameS::instance()->toggleCritterBoard();
     } else {
         if (t.data2 < 240) {
@@ -174,6 +178,7 @@ void PauseGame::performAction(Trigger&, bool isDown) {
         return;
     }
 
+    WorldLock lock;
     if (GameState::context == Context::ePaused) {
         LOG_INFO << "un-pausing..." << endl;
         GameState::context = _prevContext;
@@ -183,6 +188,7 @@ void PauseGame::performAction(Trigger&, bool isDown) {
         _prevContext = GameState::context;
         GameState::context = Context::ePaused;
         GameState::stopwatch.pause();
+        HeroS::instance()->discardInput();
     }
 }
 
@@ -0,0 +1,83 @@
+// Description:
+//   One bit per maze cell for a single element type.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include <BitPlane.hpp>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int popCount(Uint64 w) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(w);
+#else
+    return __builtin_popcountll(w);
+#endif
+}
+
+static inline int lowestBit(Uint64 w) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, w);
+    return (int)index;
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+void BitPlane::init(int size) {
+    _size = size;
+    _words.assign((size + 63) / 64, 0);
+}
+
+void BitPlane::clearAll(void) {
+    for (size_t i = 0; i < _words.size(); i++) {
+        _words[i] = 0;
+    }
+}
+
+void BitPlane::setAll(void) {
+    for (size_t i = 0; i < _words.size(); i++) {
+        _words[i] = ~(Uint64)0;
+    }
+
+    //keep the bits past the end clear so count() stays exact
+    if (_size & 63) {
+        _words.back() = ((Uint64)1 << (_size & 63)) - 1;
+    }
+}
+
+int BitPlane::count(void) const {
+    int n = 0;
+    for (size_t i = 0; i < _words.size(); i++) {
+        n += popCount(_words[i]);
+    }
+    return n;
+}
+
+int BitPlane::findNext(int i) const {
+    if (i >= _size) {
+        return -1;
+    }
+
+    size_t w = i >> 6;
+    Uint64 bits = _words[w] & (~(Uint64)0 << (i & 63));
+    while (bits == 0) {
+        if (++w == _words.size()) {
+            return -1;
+        }
+        bits = _words[w];
+    }
+    return (int)(w * 64) + lowestBit(bits);
+}
@@ -0,0 +1,48 @@
+#pragma once
+// Description:
+//   One bit per maze cell for a single element type.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <vector>
+
+#include <SDL2/SDL_stdinc.h>
+
+//Bits are stored 64 to a word, so counting and searching work a word at
+//a time: count() is a popcount per word, findNext() skips empty words.
+class BitPlane {
+public:
+    BitPlane(void) :
+        _size(0),
+        _words() {}
+
+    void init(int size);
+    void clearAll(void);
+    void setAll(void);
+
+    void set(int i) { _words[i >> 6] |= (Uint64)1 << (i & 63); }
+
+    void clear(int i) { _words[i >> 6] &= ~((Uint64)1 << (i & 63)); }
+
+    bool test(int i) const { return (_words[i >> 6] >> (i & 63)) & 1; }
+
+    //number of set bits
+    int count(void) const;
+
+    //index of the first set bit at or after i, -1 if there is none
+    int findNext(int i) const;
+
+private:
+    int _size;
+    std::vector<Uint64> _words;
+};
@@ -36,6 +36,9 @@
 #include <ScoreKeeper.hpp>
 #include <TextureManager.hpp>
 #include <PuckMaze.hpp>
+#include <FrameScheduler.hpp>
+#include <RenderSnapshot.hpp>
+#include <SimThread.hpp>
 #ifndef IPHONE
 #include <GLExtension.hpp>
 #endif
@@ -53,10 +56,12 @@
 #include "gl3/VertexArray.hpp"
 #include "gl3/ProgramManager.hpp"
 #include "gl3/MatrixStack.hpp"
+#include "gl3/StateCache.hpp"
 
 #include "glm/glm.hpp"
 #include "glm/ext.hpp"
 #include "GLVertexBufferObject.hpp"
+#include "RenderQueue.hpp"
 
 #include <algorithm>
 #include <string>
@@ -131,6 +136,9 @@ void CherriesView::initGL3Test() {
     progTexture->use();
     progTexture->release();
 
+    //instanced sprites and text, see RenderQueue
+    ProgramManagerS::instance()->createProgram("sprite");
+
     LOG_INFO << "initGL3Test DONE\n";
 }
 
@@ -179,7 +187,7 @@ bool CherriesView::init(void) {
 void CherriesView::resolutionChanged(int /*w*/, int /*h*/) {
     ProgramManagerS::instance()->reset();
     initGL3Test();
-    PuckMazeS::instance()->reset();
+    PuckMazeS::instance()->releaseTexture();
 }
 
 void CherriesView::updateLogic(void) {
@@ -202,8 +210,8 @@ void CherriesView::updateLogic(void) {
 bool CherriesView::draw(void) {
     //    XTRACE();
 
-    static float nextTime = Timer::getTime() + 0.5f;
-    float thisTime = Timer::getTime();
+    static double nextTime = Timer::getTime() + 0.5;
+    double thisTime = Timer::getTime();
     if (thisTime > nextTime) {
         nextTime = thisTime + 0.5f;
         VideoBaseS::instance()->updateSettings();
@@ -215,10 +223,18 @@ bool CherriesView::draw(void) {
     GLBitmapFont& scoreFont = *_scoreFont;
     GLBitmapFont& gameOFont = *_gameOFont;
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateCache::enable(GL_BLEND);
+    StateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    RenderQueue& renderQueue = *RenderQueueS::instance();
+
+    //the game state as of the last step, see RenderSnapshot
+    RenderSnapshot& snapshot = SnapshotBufferS::instance()->current();
+    const MazeSnapshot& maze = snapshot.maze;
 
-    glClear(GL_COLOR_BUFFER_BIT);  // | GL_DEPTH_BUFFER_BIT);
+    //the frame's draws run when the queue is flushed, so does the clear
+    renderQueue.setLayer(RenderLayer::eBackground);
+    renderQueue.addClear(GL_COLOR_BUFFER_BIT);  // | GL_DEPTH_BUFFER_BIT);
 
     //--- Ortho stuff from here on ---
     glm::mat4& projection = MatrixStack::projection.top();
@@ -227,23 +243,18 @@ bool CherriesView::draw(void) {
 
     glm::mat4& modelview = MatrixStack::model.top();
     modelview = glm::mat4(1.0);
-    {
-        Program* prog = ProgramManagerS::instance()->getProgram("texture");
-        prog->use();  //needed to set uniforms
-        GLint modelViewMatrixLoc = glGetUniformLocation(prog->id(), "modelViewMatrix");
-        glUniformMatrix4fv(modelViewMatrixLoc, 1, GL_FALSE, glm::value_ptr(projection * modelview));
-    }
 
 #ifdef IPHONE
     glTranslatef(0, 1000, 0);
     glRotatef(-90.0, 0, 0, 1);
 #endif
 
-    glDisable(GL_DEPTH_TEST);
+    StateCache::disable(GL_DEPTH_TEST);
 
     bool showFPS = false;
     ConfigS::instance()->getBoolean("showFPS", showFPS);
     if (showFPS) {
+        renderQueue.setLayer(RenderLayer::eOverlay);
         smallFont.setColor(1.0, 1.0, 1.0, 1.0);
         smallFont.DrawString(FPS::GetFPSString(), 0, 0, 1.0f, 1.0f);
     }
@@ -256,12 +267,6 @@ bool CherriesView::draw(void) {
 #endif
 
         modelview = glm::mat4(1.0);
-        {
-            Program* prog = ProgramManagerS::instance()->getProgram("texture");
-            prog->use();  //needed to set uniforms
-            GLint modelViewMatrixLoc = glGetUniformLocation(prog->id(), "modelViewMatrix");
-            glUniformMatrix4fv(modelViewMatrixLoc, 1, GL_FALSE, glm::value_ptr(projection * modelview));
-        }
 
 #ifdef IPHONE
         glTranslatef(0, 480.0, 0);
@@ -273,27 +278,25 @@ bool CherriesView::draw(void) {
 
         float mazeOffsetX = 75.0;
 
-        if (HeroS::instance()->alive()) {
-            PuckMazeS::instance()->draw(mazeOffsetX, 0, 0, 1., 1.);
+        if (snapshot.hero.alive) {
+            renderQueue.setLayer(RenderLayer::eMaze);
+            PuckMazeS::instance()->draw(maze, mazeOffsetX, 0, 0, 1., 1.);
 
-            int puckCount = PuckMazeS::instance()->Width() * PuckMazeS::instance()->Height();
+            int puckCount = maze.width * maze.height;
             if (puckCount != _numStarVertices) {
                 _numStarVertices = puckCount;
                 delete[] _starVertices;
                 _starVertices = new GLfloat[_numStarVertices * 3];
             }
 
-            float cellSize = PuckMazeS::instance()->CellSize();
+            float cellSize = maze.cellSize;
             //LOG_INFO << "cellsize = " << cellSize << "\n";
 
             int _cherrySmall = _board->getIndex("cherrySmall");
             int _banana = _board->getIndex("banana");
 
-            //glEnable(GL_TEXTURE_2D);
-            _board->bind();
-
-
             if (GameState::context == Context::ePaused) {
+                renderQueue.setLayer(RenderLayer::eHudText);
                 smallFont.setColor(1.0, 1.0, 1.0, 1.0);
                 float cx = (480.0 - smallFont.GetWidth("Paused", 1.0f)) / 2.0;
                 smallFont.DrawString("Paused", cx, 160, 1.0f, 1.0f);
@@ -301,11 +304,12 @@ bool CherriesView::draw(void) {
             }
 
             vmml::vec4f frenzyColor;
-            if (HeroS::instance()->Frenzy()) {
+            if (snapshot.hero.frenzy) {
                 frenzyColor = vmml::vec4f(1.0, 1.0, 1.0, 1.0);
             } else {
                 frenzyColor = vmml::vec4f(1.0, 1.0, 1.0, 0.15);
             }
+            renderQueue.setLayer(RenderLayer::eItems);
             _board->setColor(frenzyColor);
             _board->Draw(_frenzy, 480.0 - 90.0, 20.0, 1.0, 1.0);
 
@@ -314,16 +318,27 @@ bool CherriesView::draw(void) {
 
             bool detailCherry = cellSize > 10;
 
-            for (int y = 0; y < PuckMazeS::instance()->Height(); y++) {
-                for (int x = 0; x < PuckMazeS::instance()->Width(); x++) {
-                    float posX = (float)x * cellSize + (cellSize / 2.0) + 0.5 + mazeOffsetX;
-                    float posY = (float)y * cellSize + (cellSize / 2.0) + 0.5;
+            const int mazeWidth = maze.width;
+            const int mazeHeight = maze.height;
+
+            //visit only the cells that have the item, straight from its bit plane
+            for (int i = maze.findItem(POWERPOINT, 0); i >= 0; i = maze.findItem(POWERPOINT, i + 1)) {
+                float posX = (float)(i % mazeWidth) * cellSize + (cellSize / 2.0) + 0.5 + mazeOffsetX;
+                float posY = (float)(i / mazeWidth) * cellSize + (cellSize / 2.0) + 0.5;
+                _board->DrawC(_banana, posX, posY, cellSize / 32.0, cellSize / 32.0);
+            }
 
-                    if (PuckMazeS::instance()->isElement(x, y, POWERPOINT)) {
-                        _board->DrawC(_banana, posX, posY, cellSize / 32.0, cellSize / 32.0);
-                    } else if (detailCherry && PuckMazeS::instance()->isElement(x, y, CHERRY)) {
-                        _board->DrawC(_cherrySmall, posX, posY, cellSize / 64.0, cellSize / 64.0);
+            if (detailCherry) {
+                for (int i = maze.findItem(CHERRY, 0); i >= 0; i = maze.findItem(CHERRY, i + 1)) {
+                    int x = i % mazeWidth;
+                    int y = i / mazeWidth;
+                    if (maze.cell(x, y) & POWERPOINT) {
+                        continue;
                     }
+
+                    float posX = (float)x * cellSize + (cellSize / 2.0) + 0.5 + mazeOffsetX;
+                    float posY = (float)y * cellSize + (cellSize / 2.0) + 0.5;
+                    _board->DrawC(_cherrySmall, posX, posY, cellSize / 64.0, cellSize / 64.0);
                 }
             }
 
@@ -331,27 +346,23 @@ bool CherriesView::draw(void) {
 
             if (!detailCherry) {
                 int vIdx = 0;
-                for (int y = 0; y < PuckMazeS::instance()->Height(); y++) {
-                    for (int x = 0; x < PuckMazeS::instance()->Width(); x++) {
+                for (int y = 0; y < mazeHeight; y++) {
+                    const MazeCell* row = maze.row(y);
+                    for (int x = 0; x < mazeWidth; x++) {
                         _starVertices[vIdx++] = (float)x * cellSize + (cellSize) / 2.0 + 0.25 + mazeOffsetX;
                         _starVertices[vIdx++] = (float)y * cellSize + (cellSize) / 2.0 + 0.25;
-                        if (PuckMazeS::instance()->isElement(x, y, CHERRY)) {
-                            _starVertices[vIdx++] = 0;
-                        } else {
-                            _starVertices[vIdx++] = 2000;
-                        }
+                        _starVertices[vIdx++] = (row[x] & CHERRY) ? 0.0f : 2000.0f;
                     }
                 }
 
-#ifndef EMSCRIPTEN
-                if (PuckMazeS::instance()->Points() < (_numStarVertices / 50)) {
-                    glPointSize(cellSize - 1.0);
+                float ptSize;
+                if (maze.points < (_numStarVertices / 50)) {
+                    ptSize = cellSize - 1.0;
                 } else {
-                    float ptSize = (max)((cellSize - 1.0) / 3.0, 1.0);
-                    glPointSize(ptSize);
+                    ptSize = (max)((cellSize - 1.0) / 3.0, 1.0);
                 }
-#endif
 #if OLD_DRAW
+                glPointSize(ptSize);
                 glColor4f(0.6, 0.0, 0.0, 1.0f);
                 glEnable(GL_POINT_SMOOTH);
                 glEnableClientState(GL_VERTEX_ARRAY);
@@ -361,14 +372,17 @@ bool CherriesView::draw(void) {
 #else
                 GLVBO vbo;
                 vbo.setColor(0.6, 0.0, 0.0, 1.0f);
+                vbo.setPointSize(ptSize);
                 vbo.DrawPoints(_starVertices, _numStarVertices);
 #endif
             }
 
-            ParticleGroupManagerS::instance()->draw();
+            renderQueue.setLayer(RenderLayer::eParticles);
+            ParticleGroupManagerS::instance()->draw(snapshot.particles);
 
-            if (HeroS::instance()->alive()) {
-                HeroS::instance()->draw();
+            if (snapshot.hero.alive) {
+                renderQueue.setLayer(RenderLayer::eActors);
+                HeroS::instance()->draw(snapshot.hero);
             }
         }
 
@@ -376,19 +390,14 @@ bool CherriesView::draw(void) {
         projection = glm::ortho(-0.5f, VIDEO_ORTHO_WIDTH + 0.5f, -0.5f, VIDEO_ORTHO_HEIGHT + 0.5f, -1000.0f, 1000.0f);
 
         modelview = glm::mat4(1.0);
-        {
-            Program* prog = ProgramManagerS::instance()->getProgram("texture");
-            prog->use();  //needed to set uniforms
-            GLint modelViewMatrixLoc = glGetUniformLocation(prog->id(), "modelViewMatrix");
-            glUniformMatrix4fv(modelViewMatrixLoc, 1, GL_FALSE, glm::value_ptr(projection * modelview));
-        }
 
 #ifdef IPHONE
         glTranslatef(0, 1000, 0);
         glRotatef(-90.0, 0, 0, 1);
 #endif
 
-        if (!HeroS::instance()->alive()) {
+        if (!snapshot.hero.alive) {
+            renderQueue.setLayer(RenderLayer::eHudText);
             float cx = (1000.0 - gameOFont.GetWidth("GAME OVER", 0.8f)) / 2.0;
             gameOFont.setColor(1.0f, 1.0f, 1.0f, 0.8f);
             gameOFont.DrawString("GAME OVER", cx, 700, 0.8f, 0.8f);
@@ -400,7 +409,7 @@ bool CherriesView::draw(void) {
             smallFont.setColor(1.0f, 1.0f, 1.0f, 1.0f);
             smallFont.DrawString(text.c_str(), cx, 640, 1.9f, 1.9f);
 
-            if (ScoreKeeperS::instance()->currentIsTopTen()) {
+            if (snapshot.currentIsTopTen) {
                 if (!_textInput.isOn()) {
                     _textInput.turnOn();
                 }
@@ -417,6 +426,8 @@ bool CherriesView::draw(void) {
                 pname += currentText + "_";
                 smallFont.DrawString(pname.c_str(), 115, 420, 2.0f, 2.0f);
 
+                //the hero is gone, but the steps still run
+                WorldLock lock;
                 ScoreKeeperS::instance()->setNameForCurrent(currentText);
             }
 
@@ -426,21 +437,46 @@ bool CherriesView::draw(void) {
 
     char buff[128];
     if (GameState::isDeveloper) {
-        static float nextShow = 0;
+        static double nextShow = 0;
         static int aCount = 0;
-        float thisTime = Timer::getTime();
+        static RenderStats renderStats = renderQueue.getFrameStats();
+        static StateCache::Counters glCounters = StateCache::getFrameCounters();
+        static SchedulerStats sched = FrameSchedulerS::instance()->getStats();
+        static FrameReport frames = FrameSchedulerS::instance()->getFrameReport();
+        double thisTime = Timer::getTime();
         if (thisTime > nextShow) {
-            nextShow = thisTime + 0.5f;
-            aCount = ParticleGroupManagerS::instance()->getAliveCount();
+            nextShow = thisTime + 0.5;
+            aCount = (int)snapshot.particles.size();
+            renderStats = renderQueue.getFrameStats();
+            glCounters = StateCache::getFrameCounters();
+            sched = FrameSchedulerS::instance()->getStats();
+            frames = FrameSchedulerS::instance()->getFrameReport();
         }
+        renderQueue.setLayer(RenderLayer::eOverlay);
         sprintf(buff, "p=%d", aCount);
         smallFont.setColor(1.0f, 1.0f, 1.0f, 1.0f);
         smallFont.DrawString(buff, 0, 40, 1.0, 1.0);
+        sprintf(buff, "cmd=%d draw=%d state=%d", renderStats.commands, renderStats.drawCalls, renderStats.stateChanges);
+        smallFont.DrawString(buff, 0, 60, 1.0, 1.0);
+        sprintf(buff, "gl=%u skipped=%u", glCounters.issued, glCounters.skipped);
+        smallFont.DrawString(buff, 0, 80, 1.0, 1.0);
+
+        sprintf(buff, "%dHz steps=%d peak=%d step=%.1fms frame=%.1fms sleep=%.1fms",
+                FrameSchedulerS::instance()->getLogicRate(), sched.steps, sched.peakSteps, sched.stepCost * 1000.0f,
+                sched.frameTime * 1000.0f, sched.sleepTime * 1000.0f);
+        smallFont.DrawString(buff, 0, 100, 1.0, 1.0);
+        sprintf(buff, "limit=%u dropped=%u%s", sched.limitFrames, sched.droppedSteps, sched.spiral ? " SPIRAL" : "");
+        smallFont.DrawString(buff, 0, 120, 1.0, 1.0);
+        sprintf(buff, "p50=%.2f p95=%.2f p99=%.2f max=%.2f hitch=%u steps p99=%d", frames.p50 * 1000.0f,
+                frames.p95 * 1000.0f, frames.p99 * 1000.0f, frames.max * 1000.0f, frames.hitches, frames.stepsP99);
+        smallFont.DrawString(buff, 0, 140, 1.0, 1.0);
+        sprintf(buff, "input p50=%.2f p99=%.2f max=%.2f", frames.latencyP50 * 1000.0f, frames.latencyP99 * 1000.0f,
+                frames.latencyMax * 1000.0f);
+        smallFont.DrawString(buff, 0, 160, 1.0, 1.0);
     }
 
     if (GameState::context == Context::eMenu) {
         //glEnable(GL_TEXTURE_2D);
-        _board->bind();
         //glColor4f(1.0,1.0,1.0,1.0);
         //float scale = 1.5;
         //float xOff = (VIDEO_ORTHO_WIDTH-(_board->getWidth(_titleIndex)*scale))/2.0;
@@ -450,6 +486,7 @@ bool CherriesView::draw(void) {
 
         MenuManagerS::instance()->draw();
 
+        renderQueue.setLayer(RenderLayer::eMenuText);
         //glColor4f(1.0,1.0,1.0,0.5);
         string gVersion = "v" + GAMEVERSION;
         float width = smallFont.GetWidth(gVersion.c_str(), 0.7f);
@@ -466,24 +503,26 @@ bool CherriesView::draw(void) {
             float tx = 8.0f + _boardPosX;
 
             //glEnable(GL_TEXTURE_2D);
-            _board->bind();
+            renderQueue.setLayer(RenderLayer::eHud);
             //glColor4f(1.0,1.0,1.0,0.8);
             _board->setColor(1.0, 1.0, 1.0, 0.8);
             _board->Draw(_boardIndex, _boardPosX, VIDEO_ORTHO_HEIGHT - 256, 1.0, 1.0);
             //glDisable(GL_TEXTURE_2D);
 
-            sprintf(buff, "%d", ScoreKeeperS::instance()->getCurrentScore());
+            renderQueue.setLayer(RenderLayer::eHudText);
+
+            sprintf(buff, "%d", snapshot.currentScore);
             scoreFont.setColor(1.0, 1.0, 1.0, 1.0);
             scoreFont.DrawString(buff, tx, ty, size, size);
             ty += tdy;
 
-            sprintf(buff, "%d", ScoreKeeperS::instance()->getHighScore());
+            sprintf(buff, "%d", snapshot.highScore);
             scoreFont.setColor(1.0, 1.0, 1.0, 1.0);
             scoreFont.DrawString(buff, tx, ty, size, size);
             ty += tdy;
 
             float bLen = 1.0f;
-            float he = HeroS::instance()->Energy() / 3.0f; // Banana timer
+            float he = snapshot.hero.energy * GameState::stepScale / 3.0f; // Banana timer
             Clamp(he, 0.0, 100.0);
 #if OLD_DRAW
             glColor4f(1.0f, 1.0f, 0.1f, 0.5f);
@@ -507,7 +546,7 @@ bool CherriesView::draw(void) {
 #endif
             ty += tdy;
             //glColor4f(1.0,1.0,1.0,1.0);
-            int matchTime = HeroS::instance()->Age();
+            int matchTime = snapshot.hero.age;
             sprintf(buff, "%d.%d", matchTime / 1000, (matchTime % 1000) / 100);
             scoreFont.setColor(1.0, 1.0, 1.0, 1.0);
             scoreFont.DrawString(buff, tx, ty, size, size);
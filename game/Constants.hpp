@@ -50,13 +50,12 @@ const std::string EFFECTS_GROUP3 = "Effects3";
 
 const int MAX_PARTICLES_PER_GROUP = 2048;
 
-const float GAME_STEP_SIZE = 1.0f / 30.0f;  //run logic 30 times per second
-const int MAX_GAME_STEPS = 10;              //max number of logic runs per frame
+const float GAME_STEP_SIZE = 1.0f / 30.0f;  //logic was written for 30 steps per second
+const int MAX_GAME_STEPS = 10;              //max number of 30Hz logic runs per frame
 
 // All updates in out logic are based on a game step size of 1/30.
-// In case we want to use a different GAME_STEP_SIZE in the future,
-// multiply all update values by GAME_STEP_SCALE.
-const float GAME_STEP_SCALE = 30.0f * GAME_STEP_SIZE;
+// The in-game logic rate is configurable (see FrameScheduler), so
+// multiply all update values by GameState::stepScale.
 
 const float FONTSHADOW_OFFSET = 3.0f;
 const float OBJECT_RADIUS = 0.45f;
@@ -18,10 +18,13 @@
 #include <RandomKnuth.hpp>
 #include <Point.hpp>
 #include <Constants.hpp>
+#include <GameState.hpp>
 
 #include <BitmapManager.hpp>
 
 #include <MazeNavigation.hpp>
+#include <FlowField.hpp>
+#include <RenderSnapshot.hpp>
 
 using namespace std;
 
@@ -74,7 +77,8 @@ bool Enemy::update(ParticleInfo* p) {
     updatePrevs(p);
 
     p->damage++;
-    if (p->damage > 2) {
+    //sample the tail every 3 (30Hz) steps
+    if (p->damage >= GameState::scaledSteps(3)) {
         p->extra = p->color;
         p->color = p->velocity;
         p->velocity = p->position;
@@ -84,7 +88,26 @@ bool Enemy::update(ParticleInfo* p) {
     float& _xPos = p->position.x;
     float& _yPos = p->position.y;
 
-    Point2D delta(HeroS::instance()->lastXPos - _xPos, HeroS::instance()->lastYPos - _yPos);
+    bool flee = HeroS::instance()->Energy() > 0;
+
+    //follow the flow field to the center of the next cell on the way
+    int cellX = (int)lroundf(_xPos);
+    int cellY = (int)lroundf(_yPos);
+    FlowField* field = FlowFieldS::instance();
+    int dir = flee ? field->flee(cellX, cellY) : field->chase(cellX, cellY);
+
+    Point2D delta;
+    if (dir) {
+        delta.x = (float)(cellX + ((dir == WallRT) ? 1 : (dir == WallLT) ? -1 : 0)) - _xPos;
+        delta.y = (float)(cellY + ((dir == WallDN) ? 1 : (dir == WallUP) ? -1 : 0)) - _yPos;
+    } else {
+        //in the hero's cell or cornered, head straight for (or away from) the hero
+        delta.x = HeroS::instance()->lastXPos - _xPos;
+        delta.y = HeroS::instance()->lastYPos - _yPos;
+        if (flee) {
+            delta = delta * -1;
+        }
+    }
 
     float dist = sqrt(delta.x * delta.x + delta.y * delta.y);
     if (dist < 0.001) {
@@ -94,15 +117,10 @@ bool Enemy::update(ParticleInfo* p) {
 
     norm(delta);
 
-    if (HeroS::instance()->Energy() > 0) {
-        //run away!
-        delta = delta * -1;
-    }
-
-    float stepX = delta.x * 0.2;
-    float stepY = delta.y * 0.2;
-    Clamp(stepX, -0.4, 0.4);
-    Clamp(stepY, -0.4, 0.4);
+    float stepX = delta.x * 0.2 * GameState::stepScale;
+    float stepY = delta.y * 0.2 * GameState::stepScale;
+    Clamp(stepX, -0.4 * GameState::stepScale, 0.4 * GameState::stepScale);
+    Clamp(stepY, -0.4 * GameState::stepScale, 0.4 * GameState::stepScale);
 
     vec2f newPos = MazeNavigationS::instance()->getNextPosition(vec2f(_xPos, _yPos), vec2f(stepX, stepY));
     _xPos = newPos.x();
@@ -117,7 +135,7 @@ void Enemy::draw(ParticleInfo* p) {
 
     float mazeOffsetX = 75.0;
 
-    float cellSize = PuckMazeS::instance()->CellSize();
+    float cellSize = SnapshotBufferS::instance()->current().maze.cellSize;
     float posX = pi.position.x * cellSize + (cellSize / 2.0) + 0.5 + mazeOffsetX;
     float posY = pi.position.y * cellSize + (cellSize / 2.0) + 0.5;
 
@@ -130,16 +148,12 @@ void Enemy::draw(ParticleInfo* p) {
     float posX3 = p->extra.x * cellSize + (cellSize / 2.0) + 0.5 + mazeOffsetX;
     float posY3 = p->extra.y * cellSize + (cellSize / 2.0) + 0.5;
 
-    //glEnable(GL_TEXTURE_2D);
-    _atlas->bind();
-    //glColor4f(1.0,1.0,1.0,1.0);
+    //queued, see RenderQueue
     _atlas->setColor(1.0, 1.0, 1.0, 1.0);
-    _atlas->DrawC(_wormTail, posX3, posY3, cellSize / 28.0, cellSize / 28.0);
-    _atlas->DrawC(_wormTail, posX2, posY2, cellSize / 22.0, cellSize / 22.0);
-    _atlas->DrawC(_wormTail, posX1, posY1, cellSize / 14.0, cellSize / 14.0);
-    _atlas->DrawC(_wormHead, posX, posY, cellSize / 24.0, cellSize / 24.0);
-
-    //(GL_TEXTURE_2D);
+    _atlas->DrawInstanced(_wormTail, posX3, posY3, cellSize / 28.0, cellSize / 28.0);
+    _atlas->DrawInstanced(_wormTail, posX2, posY2, cellSize / 22.0, cellSize / 22.0);
+    _atlas->DrawInstanced(_wormTail, posX1, posY1, cellSize / 14.0, cellSize / 14.0);
+    _atlas->DrawInstanced(_wormHead, posX, posY, cellSize / 24.0, cellSize / 24.0);
 }
 
 void Enemy::hit(ParticleInfo* p, int /*damage*/, int /*radIndex*/) {
@@ -0,0 +1,119 @@
+// Description:
+//   Maze-aware directions towards and away from the hero.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include <FlowField.hpp>
+
+#include <Trace.hpp>
+#include <PuckMaze.hpp>
+#include <Hero.hpp>
+
+#include <math.h>
+
+FlowField::FlowField(void) :
+    _width(0),
+    _height(0) {
+    XTRACE();
+}
+
+FlowField::~FlowField() {
+    XTRACE();
+}
+
+void FlowField::update(void) {
+    PuckMaze* maze = PuckMazeS::instance();
+
+    if ((maze->Width() != _width) || (maze->Height() != _height)) {
+        _width = maze->Width();
+        _height = maze->Height();
+
+        int cells = _width * _height;
+        _distance.resize(cells);
+        _queue.resize(cells);
+        _chase.resize(cells);
+        _flee.resize(cells);
+    }
+
+    const int cells = _width * _height;
+    for (int i = 0; i < cells; i++) {
+        _distance[i] = -1;
+    }
+
+    int heroX = (int)lroundf(HeroS::instance()->lastXPos);
+    int heroY = (int)lroundf(HeroS::instance()->lastYPos);
+    if (!maze->isInside(heroX, heroY)) {
+        for (int i = 0; i < cells; i++) {
+            _chase[i] = 0;
+            _flee[i] = 0;
+        }
+        return;
+    }
+
+    //The outer walls are always set, so open walls never lead outside.
+    //Walls are stored on both sides, the cell's own bits are enough.
+    const int offsets[4] = {-_width, _width, -1, 1};
+    const Uint32 walls[4] = {WallUP, WallDN, WallLT, WallRT};
+
+    int head = 0;
+    int tail = 0;
+    int start = heroY * _width + heroX;
+    _distance[start] = 0;
+    _queue[tail++] = start;
+
+    while (head < tail) {
+        int pos = _queue[head++];
+        Uint32 cell = maze->cell(pos % _width, pos / _width);
+        int next = _distance[pos] + 1;
+
+        for (int d = 0; d < 4; d++) {
+            if (cell & walls[d]) {
+                continue;
+            }
+            int n = pos + offsets[d];
+            if (_distance[n] < 0) {
+                _distance[n] = next;
+                _queue[tail++] = n;
+            }
+        }
+    }
+
+    for (int pos = 0; pos < cells; pos++) {
+        Uint8 chase = 0;
+        Uint8 flee = 0;
+
+        int distance = _distance[pos];
+        if (distance >= 0) {
+            Uint32 cell = maze->cell(pos % _width, pos / _width);
+            int nearest = distance;
+            int farthest = distance;
+
+            for (int d = 0; d < 4; d++) {
+                if (cell & walls[d]) {
+                    continue;
+                }
+                int nd = _distance[pos + offsets[d]];
+                if (nd < nearest) {
+                    nearest = nd;
+                    chase = (Uint8)walls[d];
+                }
+                if (nd > farthest) {
+                    farthest = nd;
+                    flee = (Uint8)walls[d];
+                }
+            }
+        }
+
+        _chase[pos] = chase;
+        _flee[pos] = flee;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+// Description:
+//   Maze-aware directions towards and away from the hero.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <vector>
+
+#include <Singleton.hpp>
+#include <SDL2/SDL_stdinc.h>
+
+//One breadth first search from the hero's cell per game step gives every
+//cell its distance to the hero. From that each cell gets the direction
+//(WallUP, WallDN, WallLT or WallRT) to the open neighbour closer to the
+//hero (chase) and the one farther away (flee), so any number of worms can
+//look up where to go in O(1).
+class FlowField {
+    friend class Singleton<FlowField>;
+
+public:
+    //rebuild both fields from the hero's current cell
+    void update(void);
+
+    //direction to take from cell (x,y), 0 if there is none (at the hero,
+    //cornered, unreachable or outside the maze)
+    int chase(int x, int y) const { return lookup(_chase, x, y); }
+
+    int flee(int x, int y) const { return lookup(_flee, x, y); }
+
+private:
+    ~FlowField();
+    FlowField(void);
+    FlowField(const FlowField&);
+    FlowField& operator=(const FlowField&);
+
+    int lookup(const std::vector<Uint8>& field, int x, int y) const {
+        if (((unsigned int)x >= (unsigned int)_width) || ((unsigned int)y >= (unsigned int)_height)) {
+            return 0;
+        }
+        return field[y * _width + x];
+    }
+
+    int _width;
+    int _height;
+
+    std::vector<int> _distance;  //steps to the hero, -1 if unreachable
+    std::vector<int> _queue;
+    std::vector<Uint8> _chase;
+    std::vector<Uint8> _flee;
+};
+
+typedef Singleton<FlowField> FlowFieldS;
@@ -0,0 +1,337 @@
+// Description:
+//   Asynchronous frame capture.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include "SDL.h"
+
+#include <Trace.hpp>
+#include <Config.hpp>
+#include <PNG.hpp>
+
+#include <FrameCapture.hpp>
+
+#include "gl3/Buffer.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+//how long shutdown waits for a readback still in flight
+const GLuint64 FINISH_TIMEOUT_NS = 1000000000;
+
+FrameCapture::FrameCapture(void) :
+    _nextReadback(0),
+    _captureEvery(0),
+    _frame(0),
+    _snapshotCount(0),
+    _snapshotPending(false),
+    _dropped(0),
+    _thread(0),
+    _mutex(0),
+    _wake(0),
+    _quit(false),
+    _sinkMutex(0),
+    _sink(0) {
+    XTRACE();
+    for (int i = 0; i < NUM_READBACKS; i++) {
+        _readbacks[i].pbo = 0;
+        _readbacks[i].size = 0;
+        _readbacks[i].fence = 0;
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    XTRACE();
+
+    //finish what was asked for, e.g. a snapshot taken right before quitting
+    for (int i = 0; i < NUM_READBACKS; i++) {
+        int slot = (_nextReadback + i) % NUM_READBACKS;
+        if (_readbacks[slot].fence) {
+            finishReadback(_readbacks[slot], FINISH_TIMEOUT_NS);
+        }
+    }
+    reset();
+    stop();
+}
+
+void FrameCapture::init(void) {
+    ConfigS::instance()->getInteger("captureEvery", _captureEvery);
+    if (_captureEvery < 0) {
+        _captureEvery = 0;
+    }
+
+#if !defined(EMSCRIPTEN)
+    if (!_thread) {
+        _mutex = SDL_CreateMutex();
+        _wake = SDL_CreateCond();
+        _sinkMutex = SDL_CreateMutex();
+        _quit = false;
+        _thread = SDL_CreateThread(run, "FrameCapture", this);
+        if (!_thread) {
+            LOG_WARNING << "Unable to start capture thread, encoding inline: " << SDL_GetError() << endl;
+        }
+    }
+#endif
+
+    if (_captureEvery) {
+        LOG_INFO << "Capturing every " << _captureEvery << " frames" << endl;
+    }
+}
+
+void FrameCapture::stop(void) {
+    if (_thread) {
+        SDL_LockMutex(_mutex);
+        _quit = true;
+        SDL_CondSignal(_wake);
+        SDL_UnlockMutex(_mutex);
+
+        SDL_WaitThread(_thread, 0);
+        _thread = 0;
+    }
+
+    if (_wake) {
+        SDL_DestroyCond(_wake);
+        _wake = 0;
+    }
+    if (_mutex) {
+        SDL_DestroyMutex(_mutex);
+        _mutex = 0;
+    }
+    if (_sinkMutex) {
+        SDL_DestroyMutex(_sinkMutex);
+        _sinkMutex = 0;
+    }
+}
+
+void FrameCapture::reset(void) {
+    //in flight readbacks are lost with their buffers
+    for (int i = 0; i < NUM_READBACKS; i++) {
+        Readback& rb = _readbacks[i];
+        if (rb.fence) {
+            glDeleteSync(rb.fence);
+            rb.fence = 0;
+        }
+        delete rb.pbo;
+        rb.pbo = 0;
+        rb.size = 0;
+    }
+    _nextReadback = 0;
+}
+
+void FrameCapture::requestSnapshot(void) {
+    _snapshotPending = true;
+}
+
+void FrameCapture::setFrameSink(FrameSinkI* sink) {
+    if (_sinkMutex) {
+        SDL_LockMutex(_sinkMutex);
+    }
+    _sink = sink;
+    if (_sinkMutex) {
+        SDL_UnlockMutex(_sinkMutex);
+    }
+}
+
+bool FrameCapture::hasFrameSink(void) {
+    if (_sinkMutex) {
+        SDL_LockMutex(_sinkMutex);
+    }
+    bool hasSink = (_sink != 0);
+    if (_sinkMutex) {
+        SDL_UnlockMutex(_sinkMutex);
+    }
+    return hasSink;
+}
+
+void FrameCapture::endFrame(int width, int height) {
+    _frame++;
+
+#if !defined(EMSCRIPTEN)
+    //hand over the readbacks the GPU has finished
+    for (int i = 0; i < NUM_READBACKS; i++) {
+        int slot = (_nextReadback + i) % NUM_READBACKS;
+        if (_readbacks[slot].fence && !finishReadback(_readbacks[slot], 0)) {
+            break;  //later ones can't be done either
+        }
+    }
+#endif
+
+    bool continuous = (_captureEvery > 0) && ((_frame % _captureEvery) == 0);
+    if (!_snapshotPending && !continuous) {
+        return;
+    }
+
+    Readback& rb = _readbacks[_nextReadback];
+    if (rb.fence) {
+        //all slots in flight, try again next frame for a snapshot
+        if (!_snapshotPending) {
+            _dropped++;
+        }
+        return;
+    }
+
+    CaptureJob& job = rb.job;
+    job.frameNumber = _frame;
+    job.snapshot = _snapshotPending;
+    char filename[128];
+    if (_snapshotPending) {
+        sprintf(filename, "snap%02d.png", _snapshotCount++);
+        job.filename = filename;
+        LOG_INFO << "Writing snapshot: " << filename << endl;
+        _snapshotPending = false;
+    } else if (hasFrameSink()) {
+        job.filename.clear();
+    } else {
+        sprintf(filename, "capture%05u.png", _frame);
+        job.filename = filename;
+    }
+
+    startReadback(rb, width, height);
+}
+
+void FrameCapture::startReadback(Readback& rb, int width, int height) {
+    //rows of the default pack alignment (4)
+    int pitch = (width * 3 + 3) & ~3;
+    rb.job.width = width;
+    rb.job.height = height;
+    rb.job.pitch = pitch;
+
+#if defined(EMSCRIPTEN)
+    //no buffer mapping in WebGL, read straight back
+    rb.job.pixels.resize(pitch * height);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &rb.job.pixels[0]);
+    encode(rb.job);
+#else
+    if (!rb.pbo) {
+        rb.pbo = new Buffer();
+    }
+    rb.pbo->bind(GL_PIXEL_PACK_BUFFER);
+    if (rb.size != pitch * height) {
+        rb.size = pitch * height;
+        rb.pbo->setData(GL_PIXEL_PACK_BUFFER, rb.size, 0, GL_STREAM_READ);
+    }
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0);
+    Buffer::unbind(GL_PIXEL_PACK_BUFFER);
+
+    rb.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _nextReadback = (_nextReadback + 1) % NUM_READBACKS;
+#endif
+}
+
+bool FrameCapture::finishReadback(Readback& rb, GLuint64 timeout) {
+    GLenum status = glClientWaitSync(rb.fence, timeout ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+    if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED)) {
+        return false;
+    }
+    glDeleteSync(rb.fence);
+    rb.fence = 0;
+
+    rb.pbo->bind(GL_PIXEL_PACK_BUFFER);
+    const unsigned char* data = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rb.size, GL_MAP_READ_BIT);
+    if (data) {
+        rb.job.pixels.assign(data, data + rb.size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    Buffer::unbind(GL_PIXEL_PACK_BUFFER);
+
+    if (data) {
+        queueJob(rb.job);
+    } else {
+        LOG_ERROR << "Unable to map frame capture buffer." << endl;
+    }
+    return true;
+}
+
+void FrameCapture::queueJob(CaptureJob& job) {
+    if (!_thread) {
+        encode(job);
+        return;
+    }
+
+    SDL_LockMutex(_mutex);
+    if (!job.snapshot && (_jobs.size() >= MAX_QUEUED_JOBS)) {
+        //the encoder can't keep up, don't let the backlog grow
+        _dropped++;
+    } else {
+        _jobs.push_back(CaptureJob());
+        _jobs.back().filename.swap(job.filename);
+        _jobs.back().snapshot = job.snapshot;
+        _jobs.back().frameNumber = job.frameNumber;
+        _jobs.back().width = job.width;
+        _jobs.back().height = job.height;
+        _jobs.back().pitch = job.pitch;
+        _jobs.back().pixels.swap(job.pixels);
+        SDL_CondSignal(_wake);
+    }
+    SDL_UnlockMutex(_mutex);
+}
+
+int FrameCapture::run(void* data) {
+    static_cast<FrameCapture*>(data)->work();
+    return 0;
+}
+
+void FrameCapture::work(void) {
+    SDL_LockMutex(_mutex);
+    for (;;) {
+        while (_jobs.empty() && !_quit) {
+            SDL_CondWait(_wake, _mutex);
+        }
+        //write everything queued before quitting
+        if (_jobs.empty()) {
+            break;
+        }
+
+        CaptureJob job;
+        job.filename.swap(_jobs.front().filename);
+        job.snapshot = _jobs.front().snapshot;
+        job.frameNumber = _jobs.front().frameNumber;
+        job.width = _jobs.front().width;
+        job.height = _jobs.front().height;
+        job.pitch = _jobs.front().pitch;
+        job.pixels.swap(_jobs.front().pixels);
+        _jobs.pop_front();
+
+        SDL_UnlockMutex(_mutex);
+        encode(job);
+        SDL_LockMutex(_mutex);
+    }
+    SDL_UnlockMutex(_mutex);
+}
+
+void FrameCapture::encode(CaptureJob& job) {
+    if (job.filename.empty()) {
+        if (_sinkMutex) {
+            SDL_LockMutex(_sinkMutex);
+        }
+        if (_sink) {
+            _sink->frame(job.frameNumber, job.width, job.height, job.pitch, &job.pixels[0]);
+        }
+        if (_sinkMutex) {
+            SDL_UnlockMutex(_sinkMutex);
+        }
+        return;
+    }
+
+    SDL_Surface* img = SDL_CreateRGBSurfaceFrom(&job.pixels[0], job.width, job.height, 24, job.pitch, 0x00FF0000,
+                                                0x0000FF00, 0x000000FF, 0);
+    if (!img) {
+        LOG_ERROR << "Failed to create surface for snapshot: " << SDL_GetError() << endl;
+        return;
+    }
+    if (!PNG::Snapshot(img, job.filename)) {
+        LOG_ERROR << "Failed to save snapshot " << job.filename << endl;
+    }
+    SDL_FreeSurface(img);
+}
@@ -0,0 +1,120 @@
+#pragma once
+// Description:
+//   Asynchronous frame capture.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include <list>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <Singleton.hpp>
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+class Buffer;
+
+//Receives continuously captured frames on the capture thread. Pixels are
+//RGB, rows bottom up, each row padded to 'pitch' bytes.
+class FrameSinkI {
+public:
+    virtual ~FrameSinkI() {}
+    virtual void frame(unsigned int frameNumber, int width, int height, int pitch, const unsigned char* pixels) = 0;
+};
+
+//At the end of a frame the back buffer is read into one of a ring of pixel
+//buffer objects. It is mapped a few frames later, once its fence has passed,
+//so the GL thread never waits for the readback. PNG encoding, or the frame
+//sink, runs on a worker thread. Continuous capture drops frames rather than
+//stall when the ring or the encoder falls behind; snapshots wait for a slot.
+//The web build reads back and encodes synchronously.
+class FrameCapture {
+    friend class Singleton<FrameCapture>;
+
+public:
+    //reads captureEvery from config: capture every Nth frame, 0 = off
+    void init(void);
+
+    //write the next frame to snapNN.png
+    void requestSnapshot(void);
+
+    //Continuous capture feeds 'sink' instead of writing capture#####.png.
+    //Once this returns the previous sink is no longer used.
+    void setFrameSink(FrameSinkI* sink);
+
+    //Call with the finished frame in the back buffer, before the swap.
+    void endFrame(int width, int height);
+
+    //Release the GL objects, call before the context goes away.
+    void reset(void);
+
+    unsigned int getDroppedFrames(void) const { return _dropped; }
+
+private:
+    ~FrameCapture();
+    FrameCapture(void);
+    FrameCapture(const FrameCapture&);
+    FrameCapture& operator=(const FrameCapture&);
+
+    struct CaptureJob {
+        std::string filename;  //empty for the frame sink
+        bool snapshot;  //never dropped
+        unsigned int frameNumber;
+        int width;
+        int height;
+        int pitch;
+        std::vector<unsigned char> pixels;
+    };
+
+    struct Readback {
+        Buffer* pbo;
+        int size;
+        GLsync fence;  //0 while the slot is free
+        CaptureJob job;
+    };
+
+    void startReadback(Readback& rb, int width, int height);
+    bool finishReadback(Readback& rb, GLuint64 timeout);
+    void queueJob(CaptureJob& job);
+    bool hasFrameSink(void);
+
+    static int run(void* data);
+    void work(void);
+    void encode(CaptureJob& job);
+    void stop(void);
+
+    static const int NUM_READBACKS = 3;
+    static const size_t MAX_QUEUED_JOBS = 8;
+
+    Readback _readbacks[NUM_READBACKS];
+    int _nextReadback;
+
+    int _captureEvery;
+    unsigned int _frame;
+    int _snapshotCount;
+    bool _snapshotPending;
+    unsigned int _dropped;
+
+    SDL_Thread* _thread;
+    SDL_mutex* _mutex;
+    SDL_cond* _wake;
+    std::list<CaptureJob> _jobs;
+    bool _quit;
+
+    SDL_mutex* _sinkMutex;
+    FrameSinkI* _sink;
+};
+
+typedef Singleton<FrameCapture> FrameCaptureS;
@@ -0,0 +1,278 @@
+// Description:
+//   Fixed timestep logic scheduling and render frame pacing.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include "SDL.h"
+
+#include <Trace.hpp>
+#include <Config.hpp>
+#include <Timer.hpp>
+
+#include <FrameScheduler.hpp>
+#include <GameState.hpp>
+#include <Constants.hpp>
+
+#include <fstream>
+using namespace std;
+
+//frame times in 0.25ms buckets up to 250ms, steps per frame up to 32
+const double FRAME_TIME_BUCKET = 0.00025;
+const int FRAME_TIME_BUCKETS = 1000;
+const int STEP_BUCKETS = 32;
+
+FrameScheduler::FrameScheduler(void) :
+    _logicRate(30),
+    _stepSize(GAME_STEP_SIZE),
+    _maxFPS(0),
+    _hitchTime(0.05f),
+    _batchSteps(0),
+    _gameSteps(0),
+    _hitLimit(false),
+    _otherSteps(0),
+    _stepStart(0),
+    _frameStart(0),
+    _frameTimes(FRAME_TIME_BUCKET, FRAME_TIME_BUCKETS),
+    _stepsPerFrame(1.0, STEP_BUCKETS),
+    _inputLatency(FRAME_TIME_BUCKET, FRAME_TIME_BUCKETS),
+    _hitches(0) {
+    XTRACE();
+    resetStats();
+}
+
+FrameScheduler::~FrameScheduler() {
+    XTRACE();
+}
+
+void FrameScheduler::init(void) {
+    ConfigS::instance()->getInteger("logicRate", _logicRate);
+    if ((_logicRate != 30) && (_logicRate != 60) && (_logicRate != 120)) {
+        LOG_WARNING << "Unsupported logicRate " << _logicRate << ", using 30." << endl;
+        _logicRate = 30;
+    }
+    _stepSize = 1.0f / (float)_logicRate;
+    GameState::stepScale = 30.0f * _stepSize;
+
+    ConfigS::instance()->getInteger("maxFPS", _maxFPS);
+    if (_maxFPS < 0) {
+        _maxFPS = 0;
+    }
+
+    int hitchMS = 50;
+    ConfigS::instance()->getInteger("hitchMS", hitchMS);
+    _hitchTime = hitchMS / 1000.0f;
+
+    LOG_INFO << "Logic rate: " << _logicRate << "Hz, frame cap: " << _maxFPS << endl;
+
+    _frameStart = Timer::getTime();
+    resetStats();
+}
+
+void FrameScheduler::resetStats(void) {
+    _stats.steps = 0;
+    _stats.peakSteps = 0;
+    _stats.limitFrames = 0;
+    _stats.droppedSteps = 0;
+    _stats.stepCost = 0;
+    _stats.frameTime = 0;
+    _stats.sleepTime = 0;
+    _stats.spiral = false;
+
+    _frameTimes.reset();
+    _stepsPerFrame.reset();
+    _inputLatency.reset();
+    _hitches = 0;
+}
+
+FrameReport FrameScheduler::getFrameReport(void) const {
+    FrameReport report;
+    report.frames = _frameTimes.getCount();
+    report.p50 = (float)_frameTimes.getPercentile(50);
+    report.p95 = (float)_frameTimes.getPercentile(95);
+    report.p99 = (float)_frameTimes.getPercentile(99);
+    report.max = (float)_frameTimes.getMax();
+    report.hitches = _hitches;
+    report.stepsP50 = (int)_stepsPerFrame.getPercentile(50);
+    report.stepsP99 = (int)_stepsPerFrame.getPercentile(99);
+    report.stepsMax = (int)_stepsPerFrame.getMax();
+    report.inputs = _inputLatency.getCount();
+    report.latencyP50 = (float)_inputLatency.getPercentile(50);
+    report.latencyP95 = (float)_inputLatency.getPercentile(95);
+    report.latencyP99 = (float)_inputLatency.getPercentile(99);
+    report.latencyMax = (float)_inputLatency.getMax();
+    return report;
+}
+
+void FrameScheduler::dumpFrameReport(void) {
+    FrameReport r = getFrameReport();
+    LOG_INFO << "Frames: " << r.frames << " p50=" << r.p50 * 1000.0f << "ms p95=" << r.p95 * 1000.0f
+             << "ms p99=" << r.p99 * 1000.0f << "ms max=" << r.max * 1000.0f << "ms hitches=" << r.hitches << endl;
+    LOG_INFO << "Steps/frame: p50=" << r.stepsP50 << " p99=" << r.stepsP99 << " max=" << r.stepsMax
+             << " dropped=" << _stats.droppedSteps << endl;
+    LOG_INFO << "Input to swap: " << r.inputs << " p50=" << r.latencyP50 * 1000.0f << "ms p95="
+             << r.latencyP95 * 1000.0f << "ms p99=" << r.latencyP99 * 1000.0f << "ms max=" << r.latencyMax * 1000.0f
+             << "ms" << endl;
+
+    string reportFile;
+    if (!ConfigS::instance()->getString("frameReport", reportFile) || reportFile.empty()) {
+        return;
+    }
+
+    //one key=value per line for scripts
+    ofstream out(reportFile.c_str());
+    if (!out) {
+        LOG_ERROR << "Unable to write frame report: " << reportFile << endl;
+        return;
+    }
+    out << "logicRate=" << _logicRate << "\n";
+    out << "frames=" << r.frames << "\n";
+    out << "p50_ms=" << r.p50 * 1000.0f << "\n";
+    out << "p95_ms=" << r.p95 * 1000.0f << "\n";
+    out << "p99_ms=" << r.p99 * 1000.0f << "\n";
+    out << "max_ms=" << r.max * 1000.0f << "\n";
+    out << "hitch_ms=" << _hitchTime * 1000.0f << "\n";
+    out << "hitches=" << r.hitches << "\n";
+    out << "steps_p50=" << r.stepsP50 << "\n";
+    out << "steps_p99=" << r.stepsP99 << "\n";
+    out << "steps_max=" << r.stepsMax << "\n";
+    out << "limit_frames=" << _stats.limitFrames << "\n";
+    out << "dropped_steps=" << _stats.droppedSteps << "\n";
+    out << "input_frames=" << r.inputs << "\n";
+    out << "input_p50_ms=" << r.latencyP50 * 1000.0f << "\n";
+    out << "input_p95_ms=" << r.latencyP95 * 1000.0f << "\n";
+    out << "input_p99_ms=" << r.latencyP99 * 1000.0f << "\n";
+    out << "input_max_ms=" << r.latencyMax * 1000.0f << "\n";
+}
+
+bool FrameScheduler::nextStep(PausableTimer& timer, double& startOfStep, float stepSize, int& stepCount,
+                              int& dropped) {
+    double behind = timer.getTime() - startOfStep;
+    if (behind <= stepSize) {
+        return false;
+    }
+
+    //MAX_GAME_STEPS is in 30Hz steps, allow the same amount of game time at higher rates
+    int maxSteps = (int)(MAX_GAME_STEPS * GAME_STEP_SIZE / stepSize);
+    if (stepCount >= maxSteps) {
+        //We can't catch up. Drop the backlog instead of carrying it into the
+        //next frame, which would only make that frame slower (spiral of death).
+        dropped = (int)(behind / stepSize);
+        startOfStep += dropped * stepSize;
+        return false;
+    }
+
+    //advance to next start-of-game-step point in time
+    startOfStep += stepSize;
+    stepCount++;
+    return true;
+}
+
+float FrameScheduler::fraction(PausableTimer& timer, double startOfStep, float stepSize) {
+    float frameFraction = (float)((timer.getTime() - startOfStep) / stepSize);
+
+    //Higher values would try to predict were we are visually.
+    if (frameFraction > 1.0f) {
+        frameFraction = 1.0f;
+    }
+    return frameFraction;
+}
+
+bool FrameScheduler::nextGameStep(void) {
+    if (_batchSteps == 0) {
+        _stepStart = Timer::getTime();
+    }
+    int dropped = 0;
+    if (nextStep(GameState::stopwatch, GameState::startOfGameStep, _stepSize, _batchSteps, dropped)) {
+        _gameSteps++;
+        return true;
+    }
+
+    if (dropped) {
+        _stats.droppedSteps += dropped;
+        _hitLimit = true;
+    }
+    return false;
+}
+
+void FrameScheduler::endGameSteps(void) {
+    if (_batchSteps > 0) {
+        float cost = (float)((Timer::getTime() - _stepStart) / _batchSteps);
+        _stats.stepCost = _stats.stepCost * 0.9f + cost * 0.1f;
+
+        //a step that takes about as long as the time it simulates can never catch up
+        _stats.spiral = _stats.stepCost > (_stepSize * 0.9f);
+    }
+    _batchSteps = 0;
+}
+
+void FrameScheduler::updateFrameFraction(double startOfGameStep) {
+    GameState::frameFraction = fraction(GameState::stopwatch, startOfGameStep, _stepSize);
+}
+
+bool FrameScheduler::nextOtherStep(void) {
+    int dropped = 0;
+    return nextStep(GameState::mainTimer, GameState::startOfStep, GAME_STEP_SIZE, _otherSteps, dropped);
+}
+
+void FrameScheduler::endOtherSteps(void) {
+    GameState::frameFractionOther = fraction(GameState::mainTimer, GameState::startOfStep, GAME_STEP_SIZE);
+    _otherSteps = 0;
+}
+
+bool FrameScheduler::vsyncPaced(void) {
+    if (SDL_GL_GetSwapInterval() == 0) {
+        return false;
+    }
+
+    //swap already blocks at the refresh rate, a cap at or above it has nothing to do
+    SDL_DisplayMode mode;
+    if ((SDL_GetCurrentDisplayMode(0, &mode) != 0) || (mode.refresh_rate == 0)) {
+        return false;
+    }
+    return _maxFPS >= mode.refresh_rate;
+}
+
+void FrameScheduler::endFrame(void) {
+    //the steps may have run on the sim thread
+    _stats.steps = _gameSteps.exchange(0);
+    if (_stats.steps > _stats.peakSteps) {
+        _stats.peakSteps = _stats.steps;
+    }
+    if (_hitLimit.exchange(false)) {
+        _stats.limitFrames++;
+    }
+
+    double now = Timer::getTime();
+    _stats.sleepTime = 0;
+
+#if !defined(EMSCRIPTEN)
+    //the browser paces the main loop, never block it
+    if ((_maxFPS > 0) && !vsyncPaced()) {
+        double remaining = (1.0 / _maxFPS) - (now - _frameStart);
+        if (remaining > 0.001) {
+            SDL_Delay((Uint32)(remaining * 1000.0));
+            double afterSleep = Timer::getTime();
+            _stats.sleepTime = (float)(afterSleep - now);
+            now = afterSleep;
+        }
+    }
+#endif
+
+    _stats.frameTime = (float)(now - _frameStart);
+    _frameStart = now;
+
+    _frameTimes.add(_stats.frameTime);
+    _stepsPerFrame.add(_stats.steps);
+    if (_stats.frameTime > _hitchTime) {
+        _hitches++;
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+// Description:
+//   Fixed timestep logic scheduling and render frame pacing.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <atomic>
+
+#include <Singleton.hpp>
+#include <Histogram.hpp>
+
+class PausableTimer;
+
+struct SchedulerStats {
+    int steps;                  //in-game logic steps run in the last frame
+    int peakSteps;              //most steps run in a single frame
+    unsigned int limitFrames;   //frames that ran into the catch-up limit
+    unsigned int droppedSteps;  //steps discarded instead of caught up
+    float stepCost;             //smoothed wall time of one in-game step (seconds)
+    float frameTime;            //wall time of the last frame (seconds)
+    float sleepTime;            //time slept by the frame cap in the last frame
+    bool spiral;                //steps cost about as much as they simulate
+};
+
+//frame time distribution since the last resetStats()
+struct FrameReport {
+    unsigned int frames;
+    float p50, p95, p99, max;  //frame time (seconds), percentiles to 0.25ms
+    unsigned int hitches;      //frames longer than the hitch threshold
+    int stepsP50, stepsP99, stepsMax;
+    unsigned int inputs;                               //frames with input
+    float latencyP50, latencyP95, latencyP99, latencyMax;  //input event to swap (seconds)
+};
+
+class FrameScheduler {
+    friend class Singleton<FrameScheduler>;
+
+public:
+    //reads logicRate (30, 60 or 120) and maxFPS (0 = uncapped) from config
+    void init(void);
+
+    int getLogicRate(void) const { return _logicRate; }
+    float getStepSize(void) const { return _stepSize; }
+
+    //In-game logic: call nextGameStep() in a loop, one logic step per true,
+    //then endGameSteps(). The steps may run on the sim thread, see SimThread.
+    bool nextGameStep(void);
+    void endGameSteps(void);
+
+    //GameState::frameFraction for a frame drawn now, from the start of the
+    //last step in the snapshot being drawn
+    void updateFrameFraction(double startOfGameStep);
+
+    //Menu and other logic always runs at the 30Hz it was written for.
+    bool nextOtherStep(void);
+    void endOtherSteps(void);
+
+    //Call after swap. Sleeps to honour the frame cap unless vsync already does.
+    void endFrame(void);
+
+    //time from the oldest input event handled in a frame to its swap
+    void addInputLatency(double latency) { _inputLatency.add(latency); }
+
+    const SchedulerStats& getStats(void) const { return _stats; }
+    FrameReport getFrameReport(void) const;
+    void resetStats(void);
+
+    //Log the frame report and write it to the file named by the
+    //frameReport config value, if set.
+    void dumpFrameReport(void);
+
+private:
+    ~FrameScheduler();
+    FrameScheduler(void);
+    FrameScheduler(const FrameScheduler&);
+    FrameScheduler& operator=(const FrameScheduler&);
+
+    bool nextStep(PausableTimer& timer, double& startOfStep, float stepSize, int& stepCount, int& dropped);
+    float fraction(PausableTimer& timer, double startOfStep, float stepSize);
+    bool vsyncPaced(void);
+
+    int _logicRate;
+    float _stepSize;
+    int _maxFPS;
+    float _hitchTime;
+
+    int _batchSteps;               //steps in the current nextGameStep() loop
+    std::atomic<int> _gameSteps;   //steps since the last endFrame()
+    std::atomic<bool> _hitLimit;
+    int _otherSteps;
+    double _stepStart;
+    double _frameStart;
+
+    SchedulerStats _stats;
+    Histogram _frameTimes;
+    Histogram _stepsPerFrame;
+    Histogram _inputLatency;
+    unsigned int _hitches;
+};
+
+typedef Singleton<FrameScheduler> FrameSchedulerS;
@@ -19,8 +19,13 @@
 #include <Constants.hpp>
 #include <Config.hpp>
 #include <PausableTimer.hpp>
+#include <FrameScheduler.hpp>
 #include <ScoreKeeper.hpp>
 #include <PuckMaze.hpp>
+#include <FlowField.hpp>
+#include <JobPool.hpp>
+#include <SimThread.hpp>
+#include <RenderSnapshot.hpp>
 #include <RandomKnuth.hpp>
 
 #include <Audio.hpp>
@@ -35,6 +40,7 @@
 #include <ModelManager.hpp>
 #include <MenuManager.hpp>
 #include <ResourceManager.hpp>
+#include <SaveQueue.hpp>
 
 #if defined(EMSCRIPTEN)
 #include <emscripten.h>
@@ -43,7 +49,10 @@
 
 static RandomKnuth _random;
 
-Game::Game(void) {
+Game::Game(void) :
+    _view(0),
+    _heroType(-1),
+    _wormType(-1) {
     XTRACE();
 }
 
@@ -52,12 +61,21 @@ Game::~Game() {
 
     LOG_INFO << "Shutting down..." << endl;
 
+    //stop stepping before anything it uses goes away
+    SimThreadS::cleanup();
+
+    FrameSchedulerS::instance()->dumpFrameReport();
+
 #ifndef DEMO
     // save config stuff
     ConfigS::instance()->saveToFile();
 
     // save leaderboard
     ScoreKeeperS::instance()->save();
+
+    //wait for the saves to hit the disk before anything else shuts down
+    SaveQueueS::instance()->flush();
+    SaveQueueS::cleanup();
 #endif
 
     MenuManagerS::cleanup();
@@ -71,8 +89,12 @@ Game::~Game() {
     InputS::cleanup();
 
     PuckMazeS::cleanup();
+    FlowFieldS::cleanup();
+    JobPoolS::cleanup();
 
     HeroS::cleanup();  //has to be after ParticleGroupManager
+    FrameSchedulerS::cleanup();
+    SnapshotBufferS::cleanup();
 
     // Note: this shuts down PHYSFS
     LOG_INFO << "ResourceManager cleanup..." << endl;
@@ -91,6 +113,8 @@ bool Game::init(void) {
     if (!_view->init()) {
         return false;
     }
+    FrameSchedulerS::instance()->init();
+    JobPoolS::instance()->init();
 
     // init subsystems et al
     if (!ParticleGroupManagerS::instance()->init()) {
@@ -143,6 +167,10 @@ bool Game::init(void) {
     //pgm->addLink( HERO_GROUP, SHOOTABLE_ENEMY_BULLETS_GROUP);
     //pgm->addLink( HERO_GROUP, SHOOTABLE_BONUS_GROUP);
 
+    //the first group init registered the particle types
+    _heroType = ParticleGroup::getParticleTypeId("Hero");
+    _wormType = ParticleGroup::getParticleTypeId("Worm");
+
     //reset our stopwatch
     GameState::stopwatch.reset();
     GameState::stopwatch.pause();
@@ -156,13 +184,17 @@ bool Game::init(void) {
 #endif
 
     //add our hero...
-    ParticleGroupManagerS::instance()->getParticleGroup(HERO_GROUP)->newParticle(string("Hero"), 0, 0, -100);
+    ParticleGroupManagerS::instance()->getParticleGroup(HERO_GROUP)->newParticle(_heroType, 0, 0, -100);
 
     //make sure we start of in menu mode
     MenuManagerS::instance()->turnMenuOn();
 
     GameState::startOfStep = GameState::mainTimer.getTime();
     GameState::startOfGameStep = GameState::stopwatch.getTime();
+    publishSnapshot();
+
+    //last, the steps may start running right away
+    SimThreadS::instance()->init();
 
     LOG_INFO << "Initialization complete OK." << endl;
 
@@ -179,10 +211,10 @@ void Game::nextLevel(void) {
 
     PuckMazeS::instance()->AddPowerpoints((int)GameState::skill + 1);
 
+    //Enemy::init picks the positions
+    vector<vec3> origins(wormCount, vec3(0, 0, 0));
     ParticleGroup* pg = ParticleGroupManagerS::instance()->getParticleGroup(ENEMIES_GROUP);
-    for (int i = 0; i < wormCount; i++) {
-        pg->newParticle(string("Worm"), 0, 0, 0);
-    }
+    pg->newParticles(_wormType, wormCount, &origins[0]);
 }
 
 void Game::reset(void) {
@@ -199,7 +231,7 @@ void Game::reset(void) {
 
     ParticleGroupManagerS::instance()->reset();  //updates all particles one more time so they can die
     HeroS::instance()->reset();
-    ParticleGroupManagerS::instance()->getParticleGroup(HERO_GROUP)->newParticle(string("Hero"), 0, 0, -100);
+    ParticleGroupManagerS::instance()->getParticleGroup(HERO_GROUP)->newParticle(_heroType, 0, 0, -100);
 
     GameState::worminess = 0;
     nextLevel();
@@ -219,7 +251,9 @@ void Game::startNewGame(void) {
     //VideoBase::instance()->showFullscreenImage("Loading");
     // #warning FIXME
 
+    WorldLock lock;
     GameS::instance()->reset();
+    publishSnapshot();
     GameState::context = Context::eInGame;
     SDL_SetRelativeMouseMode(SDL_TRUE);
     InputS::instance()->disableInterceptor();
@@ -234,76 +268,52 @@ void Game::toggleCritterBoard(void) {
 }
 
 void Game::updateOtherLogic(void) {
-    int stepCount = 0;
-    float currentTime = GameState::mainTimer.getTime();
-    while ((currentTime - GameState::startOfStep) > GAME_STEP_SIZE) {
+    FrameScheduler& scheduler = *FrameSchedulerS::instance();
+    while (scheduler.nextOtherStep()) {
         //FIXME: shouldn't run all the time...
         MenuManagerS::instance()->update();
 
-        //advance to next start-of-game-step point in time
-        GameState::startOfStep += GAME_STEP_SIZE;
-        currentTime = GameState::mainTimer.getTime();
-
-        stepCount++;
-        if (stepCount > MAX_GAME_STEPS) {
-            break;
-        }
-    }
-
-    GameState::frameFractionOther = (currentTime - GameState::startOfStep) / GAME_STEP_SIZE;
-
-    if (stepCount > 1) {
-        //LOG_WARNING << "Skipped " << stepCount << " frames." << endl;
-
-        if (GameState::frameFractionOther > 1.0) {
-            //Our logic is still way behind where it should be at this
-            //point in time. If we get here we already ran through
-            //MAX_GAME_STEPS logic runs trying to catch up.
-
-            //We clamp the value to 1.0, higher values would try
-            //to predict were we are visually. Maybe not a bad idead
-            //to allow values up to let's say 1.3...
-            GameState::frameFractionOther = 1.0;
+        //the critter board slides at the 30Hz it was written for
+        if (GameState::context == Context::eInGame) {
+            _view->updateLogic();
         }
     }
+    scheduler.endOtherSteps();
 }
 
 void Game::updateInGameLogic(void) {
-    int stepCount = 0;
-    float currentGameTime = GameState::stopwatch.getTime();
-    while ((currentGameTime - GameState::startOfGameStep) > GAME_STEP_SIZE) {
+    FrameScheduler& scheduler = *FrameSchedulerS::instance();
+    int steps = 0;
+    while (scheduler.nextGameStep()) {
+        //one path search for all worms
+        FlowFieldS::instance()->update();
+
         // update all objects, particles, etc.
         ParticleGroupManagerS::instance()->update();
+        steps++;
+    }
+    scheduler.endGameSteps();
 
-        //FIXME: Currently the Critterboard is updated in the video system. Should be on its own.
-        _view->updateLogic();
-
-        //advance to next start-of-game-step point in time
-        GameState::startOfGameStep += GAME_STEP_SIZE;
-        currentGameTime = GameState::stopwatch.getTime();
-
-        stepCount++;
-        if (stepCount > MAX_GAME_STEPS) {
-            break;
-        }
+    if (steps > 0) {
+        publishSnapshot();
     }
+}
 
-    GameState::frameFraction = (currentGameTime - GameState::startOfGameStep) / GAME_STEP_SIZE;
+//Copy what the view draws into the back snapshot and hand it over.
+void Game::publishSnapshot(void) {
+    RenderSnapshot& snapshot = SnapshotBufferS::instance()->back();
+    snapshot.startOfGameStep = GameState::startOfGameStep;
 
-    if (stepCount > 1) {
-        //LOG_WARNING << "Skipped2 " << stepCount << " frames." << endl;
+    PuckMazeS::instance()->snapshot(snapshot.maze);
+    HeroS::instance()->snapshot(snapshot.hero);
+    ParticleGroupManagerS::instance()->snapshot(snapshot.particles, snapshot.payloads);
 
-        if (GameState::frameFraction > 1.0) {
-            //Our logic is still way behind where it should be at this
-            //point in time. If we get here we already ran through
-            //MAX_GAME_STEPS logic runs trying to catch up.
+    ScoreKeeper* scoreKeeper = ScoreKeeperS::instance();
+    snapshot.currentScore = scoreKeeper->getCurrentScore();
+    snapshot.highScore = scoreKeeper->getHighScore();
+    snapshot.currentIsTopTen = scoreKeeper->currentIsTopTen();
 
-            //We clamp the value to 1.0, higher values would try
-            //to predict were we are visually. Maybe not a bad idead
-            //to allow values up to let's say 1.3...
-            GameState::frameFraction = 1.0;
-        }
-    }
+    SnapshotBufferS::instance()->publish();
 }
 
 void Game::gameLoop(void) {
@@ -312,28 +322,38 @@ void Game::gameLoop(void) {
     Audio& audio = *AudioS::instance();
     Input& input = *InputS::instance();
 
-    switch (GameState::context) {
-        case Context::eInGame:
-            //stuff that only needs updating when game is actually running
-            game.updateInGameLogic();
-            break;
+    //poll input first so this frame's logic steps already see it
+    input.update();
+
+    //with the sim thread the steps run whenever they are due
+    if (!SimThreadS::instance()->isRunning()) {
+        switch (GameState::context) {
+            case Context::eInGame:
+                //stuff that only needs updating when game is actually running
+                game.updateInGameLogic();
+                break;
 
-        default:
-            break;
+            default:
+                break;
+        }
     }
 
     //stuff that should run all the time
     game.updateOtherLogic();
 
-    input.update();
     audio.update();
+
+    //draw the latest snapshot as of now
+    RenderSnapshot& snapshot = SnapshotBufferS::instance()->acquire();
+    FrameSchedulerS::instance()->updateFrameFraction(snapshot.startOfGameStep);
     game._view->draw();
     VideoBaseS::instance()->swap();
 
-    GLenum err;
-    while ((err = glGetError()) != GL_NO_ERROR) {
-        LOG_ERROR << "GL ERROR: " << std::hex << err << "\n";
+    double inputTime = input.takeOldestEventTime();
+    if (inputTime >= 0) {
+        FrameSchedulerS::instance()->addInputLatency(Timer::getTime() - inputTime);
     }
+    FrameSchedulerS::instance()->endFrame();
 
 #if defined(EMSCRIPTEN)
     if (GameState::requestExit) {
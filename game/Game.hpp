@@ -28,6 +28,9 @@ public:
     void startNewGame(void);
     void toggleCritterBoard(void);
 
+    //run the in-game logic steps that are due, from the main loop or SimThread
+    void updateInGameLogic(void);
+
     static void gameLoop(void);
 
 private:
@@ -37,9 +40,13 @@ private:
     Game& operator=(const Game&);
 
     void updateOtherLogic(void);
-    void updateInGameLogic(void);
+    void publishSnapshot(void);
 
     CherriesView* _view;
+
+    //particle type ids, see ParticleGroup::getParticleTypeId
+    int _heroType;
+    int _wormType;
 };
 
 typedef Singleton<Game> GameS;
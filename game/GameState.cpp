@@ -20,11 +20,12 @@ bool GameState::isAlive = true;
 
 bool GameState::showFPS = false;
 
-float GameState::startOfStep = 0;
+double GameState::startOfStep = 0;
 float GameState::frameFractionOther = 0.0;
-float GameState::startOfGameStep = 0;
+double GameState::startOfGameStep = 0;
 float GameState::frameFraction = 0.0;
-float GameState::startOfGame = 0;
+double GameState::startOfGame = 0;
+float GameState::stepScale = 1.0;
 
 float GameState::horsePower = 100.0;
 int GameState::numObjects = 0;
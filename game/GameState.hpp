@@ -25,11 +25,15 @@ struct GameState {
 
     static bool showFPS;
 
-    static float startOfStep;
+    static double startOfStep;
     static float frameFractionOther;
-    static float startOfGameStep;
+    static double startOfGameStep;
     static float frameFraction;
-    static float startOfGame;
+    static double startOfGame;
+    static float stepScale;
+
+    //number of logic steps that take as long as n steps at 30Hz
+    static int scaledSteps(int n) { return (int)((float)n / stepScale + 0.5f); }
 
     static float horsePower;
     static int numObjects;
@@ -27,6 +27,7 @@
 #include <RandomKnuth.hpp>
 #include <PuckMaze.hpp>
 #include <Constants.hpp>
+#include <RenderSnapshot.hpp>
 
 #include <BitmapManager.hpp>
 
@@ -36,6 +37,7 @@
 using namespace vmml;
 
 #include <GL/glew.h>
+#include "SDL_mutex.h"
 
 using namespace std;
 
@@ -51,7 +53,7 @@ Hero::Hero() :
     pInfo(0),
     _tracer(0),
     _maxY(MIN_Y),
-    _directions(0) {
+    _inputMutex(SDL_CreateMutex()) {
     XTRACE();
     for (int i = 0; i < 360; i++) {
         _sint[i] = sin(i * ((float)M_PI / 180.0f));
@@ -81,7 +83,13 @@ void Hero::reset(void) {
     _moveDown = 0;
     _energy = 0;
     _doTrace = false;
-    _directions = 0;
+    _input.dx = 0;
+    _input.dy = 0;
+    _input.directions = 0;
+    _input.trace = false;
+    SDL_LockMutex(_inputMutex);
+    _pendingInput.clear();
+    SDL_UnlockMutex(_inputMutex);
 
     lastXPos = 0.0;
     lastYPos = 0.0;
@@ -101,6 +109,7 @@ Hero::~Hero() {
     XTRACE();
 
     delete _tracer;
+    SDL_DestroyMutex(_inputMutex);
 }
 
 void Hero::init(ParticleInfo* p) {
@@ -144,7 +153,7 @@ void Hero::hit(ParticleInfo* p, ParticleInfo* p2, int /*radIndex*/) {
                 "ExplosionPiece", p->position.x, p->position.y, p->position.z);
         }
 #endif
-        _isDyingDelay = 20;
+        _isDyingDelay = GameState::scaledSteps(20);
         _isDying = true;
         ScoreKeeperS::instance()->addToCurrentScore(0);  //update playing time
         AudioS::instance()->playSample("sounds/gameOver");
@@ -188,6 +197,13 @@ bool Hero::update(ParticleInfo* p) {
         _energy--;
     }
 
+    //consume the input for this step, motion is relative so it starts over
+    applyInput(GameState::startOfGameStep);
+    InputFrame input = _input;
+    _input.dx = 0;
+    _input.dy = 0;
+
+    _doTrace = input.trace;
     if (_doTrace) {
         int newX = lroundf(_xPos);
         int newY = lroundf(_yPos);
@@ -195,16 +211,19 @@ bool Hero::update(ParticleInfo* p) {
         _xPos = newX;
         _yPos = newY;
     } else {
-        if (_directions & Direction::eDown) {
+        if ((input.dx != 0) || (input.dy != 0)) {
+            moveBy(input.dx, input.dy);
+        }
+        if (input.directions & Direction::eDown) {
             move(Direction::eDown, true);
         }
-        if (_directions & Direction::eUp) {
+        if (input.directions & Direction::eUp) {
             move(Direction::eUp, true);
         }
-        if (_directions & Direction::eLeft) {
+        if (input.directions & Direction::eLeft) {
             move(Direction::eLeft, true);
         }
-        if (_directions & Direction::eRight) {
+        if (input.directions & Direction::eRight) {
             move(Direction::eRight, true);
         }
     }
@@ -248,20 +267,29 @@ bool Hero::Move(int& x, int& y, int dir) {
 }
 
 void Hero::Check(int x, int y) {
-    if (PuckMazeS::instance()->isElement(x, y, CHERRY)) {
-        PuckMazeS::instance()->ClearPoint(x, y);
+    PuckMaze* maze = PuckMazeS::instance();
+    if (!maze->isInside(x, y)) {
+        LOG_ERROR << "Check out of bounds " << x << "," << y << "\n";
+        return;
+    }
+
+    Uint32 cell = maze->cell(x, y);
+    if (cell & CHERRY) {
+        maze->ClearPoint(x, y);
         ScoreKeeperS::instance()->addToCurrentScore(1);
         AudioS::instance()->playSample("sounds/tick");
     }
 
-    if (PuckMazeS::instance()->isElement(x, y, POWERPOINT)) {
+    if (cell & POWERPOINT) {
         PuckMazeS::instance()->RemoveElement(x, y, POWERPOINT);
         ScoreKeeperS::instance()->addToCurrentScore(100);
-        _energy += 120 + (30 * ((int)GameState::skill + 1));
+        _energy += GameState::scaledSteps(120 + (30 * ((int)GameState::skill + 1)));
         //LOG_INFO << "energy = " << _energy << "\n";
     }
 
-    if (PuckMazeS::instance()->Points() == 0) {
+    //the cherry plane decides, the running count is only checked against it
+    if (maze->countItems(CHERRY) == 0) {
+        maze->verifyPoints();
         //_isDyingDelay = 60; //2 sec
 #if 0
         _isDying = true;
@@ -269,6 +297,9 @@ void Hero::Check(int x, int y) {
         GameS::instance()->nextLevel();
 
         ScoreKeeperS::instance()->addToCurrentScore(0);  //update playing time
+#ifndef DEMO
+        ScoreKeeperS::instance()->save();  //in the background
+#endif
         AudioS::instance()->playSample("sounds/gameOverWon");
     }
     //LOG_INFO << "Remaining: " << PuckMazeS::instance()->Points() << "\n";
@@ -329,11 +360,89 @@ void Hero::Track(int& x, int& y, int element) {
     Move(x, y, dir);
 }
 
-void Hero::tap(bool isDown) {
-    _doTrace = isDown;
+void Hero::tap(bool isDown, double time) {
+    TimedInput in;
+    in.kind = eTraceInput;
+    in.isDown = isDown;
+    queueInput(in, time);
+}
+
+void Hero::move(float dx, float dy, double time) {
+    TimedInput in;
+    in.kind = eMotionInput;
+    in.dx = dx;
+    in.dy = dy;
+    queueInput(in, time);
+}
+
+void Hero::applyDirection(Direction::DirectionEnum dir, bool isDown, double time) {
+    TimedInput in;
+    in.kind = eDirectionInput;
+    in.direction = dir;
+    in.isDown = isDown;
+    queueInput(in, time);
 }
 
-void Hero::move(float dx, float dy) {
+void Hero::queueInput(TimedInput& in, double time) {
+    //how long ago it happened in game time, the stopwatch doesn't run while paused
+    in.time = GameState::stopwatch.getTime() - (Timer::getTime() - time);
+
+    SDL_LockMutex(_inputMutex);
+    _pendingInput.push_back(in);
+    SDL_UnlockMutex(_inputMutex);
+}
+
+//Fold input that happened before stepEnd into the input frame. Later input
+//stays queued for the step it belongs to.
+void Hero::applyInput(double stepEnd) {
+    SDL_LockMutex(_inputMutex);
+    size_t kept = 0;
+    for (size_t i = 0; i < _pendingInput.size(); i++) {
+        TimedInput& in = _pendingInput[i];
+        if (in.time > stepEnd) {
+            _pendingInput[kept++] = in;
+            continue;
+        }
+
+        switch (in.kind) {
+            case eMotionInput:
+                _input.dx += in.dx;
+                _input.dy += in.dy;
+                break;
+            case eDirectionInput:
+                if (in.isDown) {
+                    _input.directions = _input.directions | in.direction;
+                } else {
+                    _input.directions = _input.directions & ~in.direction;
+                }
+                break;
+            case eTraceInput:
+                _input.trace = in.isDown;
+                break;
+        }
+    }
+    _pendingInput.resize(kept);
+    SDL_UnlockMutex(_inputMutex);
+}
+
+//Leaving the game (pause, menu, flyby). Queued motion is dropped so the hero
+//doesn't jump on return, button state is kept so releases aren't lost.
+void Hero::discardInput(void) {
+    SDL_LockMutex(_inputMutex);
+    for (size_t i = 0; i < _pendingInput.size(); i++) {
+        _pendingInput[i].time = 0;
+        if (_pendingInput[i].kind == eMotionInput) {
+            _pendingInput[i].dx = 0;
+            _pendingInput[i].dy = 0;
+        }
+    }
+    SDL_UnlockMutex(_inputMutex);
+    applyInput(0);
+    _input.dx = 0;
+    _input.dy = 0;
+}
+
+void Hero::moveBy(float dx, float dy) {
     //    XTRACE();
     if (!_isAlive || _isDying) {
         return;
@@ -345,6 +454,7 @@ void Hero::move(float dx, float dy) {
     float& _xPos = pInfo->position.x;
     float& _yPos = pInfo->position.y;
 
+    //navigation only knows the walls around the current cell
     float stepX = dx * 0.2;
     float stepY = dy * 0.2;
     Clamp(stepX, -0.8, 0.8);
@@ -357,15 +467,6 @@ void Hero::move(float dx, float dy) {
     Check(lroundf(_xPos), lroundf(_yPos));
 }
 
-void Hero::applyDirection(Direction::DirectionEnum dir, bool isDown) {
-    if (isDown) {
-        _directions = _directions | dir;
-    }
-    else {
-        _directions = _directions & ~dir;
-    }
-}
-
 void Hero::move(Direction::DirectionEnum dir, bool isDown) {
     //    XTRACE();
     if (!_isAlive || _isDying) {
@@ -377,7 +478,7 @@ void Hero::move(Direction::DirectionEnum dir, bool isDown) {
     float stepY = 0.0f;
 
     if (isDown) {
-        delta = 0.6f * GAME_STEP_SCALE;
+        delta = 0.6f * GameState::stepScale;
     } else {
         delta = 0;
     }
@@ -412,21 +513,33 @@ void Hero::move(Direction::DirectionEnum dir, bool isDown) {
     Check(lroundf(_xPos), lroundf(_yPos));
 }
 
-void Hero::draw(void) {
-    //    XTRACE();
-    if (!_isAlive || _isDying) {
-        return;
+void Hero::snapshot(HeroSnapshot& s) {
+    s.alive = _isAlive;
+    s.visible = _isAlive && !_isDying && pInfo;
+    s.invincible = _invincibleUntil > _age;
+    s.frenzy = Frenzy();
+    s.energy = _energy;
+    s.age = _age;
+    if (pInfo) {
+        s.info = *pInfo;
+        s.info.next = 0;
+        s.info.payload = 0;
     }
-    if (!pInfo) {
+}
+
+void Hero::draw(const HeroSnapshot& s) {
+    //    XTRACE();
+    if (!s.visible) {
         return;
     }
 
+    ParticleInfo info = s.info;
     ParticleInfo pi;
-    interpolate(pInfo, pi);
+    interpolate(&info, pi);
 
     float mazeOffsetX = 75.0;
 
-    float cellSize = PuckMazeS::instance()->CellSize();
+    float cellSize = SnapshotBufferS::instance()->current().maze.cellSize;
     float posX = pi.position.x * cellSize + (cellSize / 2.0) + 0.5 + mazeOffsetX;
     float posY = pi.position.y * cellSize + (cellSize / 2.0) + 0.5;
 #if 1
@@ -435,7 +548,7 @@ void Hero::draw(void) {
 
     vec4f color;
     static int flicker = 10;
-    if (_invincibleUntil > _age) {
+    if (s.invincible) {
         //LOG_INFO << flicker << endl;
         flicker--;
         if (flicker <= 0) {
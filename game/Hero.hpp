@@ -22,7 +22,21 @@
 #include <Tracer.hpp>
 #include <GLBitmapCollection.hpp>
 
+//Input for one logic step. Triggers queue timestamped changes, Hero::update
+//folds the ones that happened before the end of the step into the frame
+//and consumes it once per step.
+struct InputFrame {
+    float dx;        //accumulated mouse motion
+    float dy;
+    int directions;  //Direction bits held down
+    bool trace;
+};
+
 #include <string>
+#include <vector>
+
+struct HeroSnapshot;
+struct SDL_mutex;
 
 class Hero : public ParticleType {
     friend class Singleton<Hero>;
@@ -39,14 +53,19 @@ public:
         ;
     }
 
-    virtual void draw(void);
+    //copy what the view needs, see RenderSnapshot
+    void snapshot(HeroSnapshot& s);
+    void draw(const HeroSnapshot& s);
 
     void nextLevel(void);
 
-    void tap(bool isDown);
-    void move(float dx, float dy);
-    void move(Direction::DirectionEnum d, bool isDown);
-    void applyDirection(Direction::DirectionEnum d, bool isDown);
+    //input at Timer::getTime() time, applied on the first logic step ending after it,
+    //safe to call while the steps run on the sim thread
+    void tap(bool isDown, double time);
+    void move(float dx, float dy, double time);
+    void applyDirection(Direction::DirectionEnum d, bool isDown, double time);
+    //drop queued motion, e.g. when the game is paused
+    void discardInput(void);
 
     bool Move(int& x, int& y, int dir);
     void Check(int x, int y);
@@ -73,6 +92,22 @@ private:
     Hero(const Hero&);
     Hero& operator=(const Hero&);
 
+    void move(Direction::DirectionEnum d, bool isDown);
+    void moveBy(float dx, float dy);
+
+    enum InputKind { eMotionInput, eDirectionInput, eTraceInput };
+    struct TimedInput {
+        double time;  //stopwatch time
+        InputKind kind;
+        float dx;
+        float dy;
+        int direction;
+        bool isDown;
+    };
+
+    void queueInput(TimedInput& in, double time);
+    void applyInput(double stepEnd);
+
     bool _doTrace;
     NEWTracer* _tracer;
 
@@ -90,7 +125,9 @@ private:
     int _invincibleUntil;
     int _isDyingDelay;
     int _age;
-    int _directions;
+    InputFrame _input;
+    std::vector<TimedInput> _pendingInput;
+    SDL_mutex* _inputMutex;  //guards _pendingInput
 
     float _sint[360];
     float _cost[360];
@@ -43,12 +43,18 @@ Input::Input(void) :
     _bindMode(false),
     _action(""),
     _callbackManager(),
+    _keyDispatch(),
+    _buttonDispatch(),
+    _motionDispatch(0),
     _mousePos(0, 0),
     _mouseDelta(0, 0),
+    _mouseDeltaTime(-1),
     _mouseSensitivity(1.0f),
+    _oldestEventTime(-1),
     _interceptor(0),
     _touchCount(0) {
     XTRACE();
+    rebuildDispatch();
 }
 
 Input::~Input() {
@@ -406,6 +412,14 @@ bool Input::tryGetTrigger(Trigger& trigger, bool& isDown) {
         return false;
     }
 
+    //SDL timestamps are in ms since SDL init, move them to our clock
+    Uint32 age = SDL_GetTicks() - event.common.timestamp;
+    if (age > 1000) {
+        //synthetic events may not carry a timestamp
+        age = 0;
+    }
+    trigger.time = Timer::getTime() - age / 1000.0;
+
     if (event.type == SDL_KEYDOWN && event.key.repeat != 0) {
         // skip key repeats
         return false;
@@ -572,6 +586,7 @@ bool Input::update(void) {
     }
 
     _mouseDelta = vec2f(0, 0);
+    _mouseDeltaTime = -1;
 
     while (tryGetTrigger(trigger, isDown)) {
         if (trigger.type == eUnknownTrigger) {
@@ -582,6 +597,9 @@ bool Input::update(void) {
         if (trigger.type == eMotionTrigger) {
             //LOG_INFO << "dx: " << trigger.fData1 << " dy: " << trigger.fData2 << "\n";
             _mouseDelta += vec2f(trigger.fData1, trigger.fData2);
+            if (_mouseDeltaTime < 0) {
+                _mouseDeltaTime = trigger.time;
+            }
             continue;
         }
 #endif
@@ -642,6 +660,10 @@ bool Input::update(void) {
             continue;
         }
 
+        if ((_oldestEventTime < 0) || (trigger.time < _oldestEventTime)) {
+            _oldestEventTime = trigger.time;
+        }
+
         if (_interceptor) {
             //feed trigger to interceptor instead of normal callback mechanism
             _interceptor->input(trigger, isDown);
@@ -652,7 +674,7 @@ bool Input::update(void) {
         if (!_bindMode) {
             //find callback for this trigger
             //i.e. the action bound to this key
-            Callback* cb = findHash(trigger, _callbackMap);
+            Callback* cb = findCallback(trigger);
             if (cb) {
                 //LOG_INFO << "Callback for [" << cb->getActionName() << "]" << endl;
                 cb->performAction(trigger, isDown);
@@ -668,13 +690,18 @@ bool Input::update(void) {
         Clampf(_mousePos.x(), 0, (float)VideoBaseS::instance()->getWidth());
         Clampf(_mousePos.y(), 0, (float)VideoBaseS::instance()->getHeight());
 
+        trigger.type = eMotionTrigger;
         trigger.fData1 = _mouseDelta.x();
         trigger.fData2 = _mouseDelta.y();
+        trigger.time = _mouseDeltaTime;
+        if ((_oldestEventTime < 0) || (trigger.time < _oldestEventTime)) {
+            _oldestEventTime = trigger.time;
+        }
         if (_interceptor) {
             //feed trigger to interceptor instead of normal callback mechanism
             _interceptor->input(trigger, true);
         } else {
-            Callback* cb = findHash(trigger, _callbackMap);
+            Callback* cb = _motionDispatch;
             if (cb) {
                 //LOG_INFO << "Callback for [" << cb->getActionName() << "]" << endl;
                 cb->performAction(trigger, isDown);
@@ -685,6 +712,12 @@ bool Input::update(void) {
     return true;
 }
 
+double Input::takeOldestEventTime(void) {
+    double t = _oldestEventTime;
+    _oldestEventTime = -1;
+    return t;
+}
+
 void Input::addCallback(Callback* cb) {
     if (cb) {
         _callbackManager.addCallback(cb);
@@ -742,4 +775,81 @@ void Input::bind(Trigger& trigger, Callback* callback) {
     LOG_INFO << "Creating binding for " << callback->getActionName() << " - " << trigger.type << ":" << trigger.data3
              << " sym: " << trigger.data1 << endl;
     _callbackMap[trigger] = callback;
+
+    rebuildDispatch();
+}
+
+void Input::rebuildDispatch(void) {
+    for (int i = 0; i < SDL_NUM_SCANCODES; i++) {
+        _keyDispatch[i].count = 0;
+    }
+    for (int i = 0; i < MAX_BUTTONS; i++) {
+        _buttonDispatch[i] = 0;
+    }
+    _motionDispatch = 0;
+
+    hash_map<Trigger, Callback*, hash<Trigger>, std::equal_to<Trigger>>::const_iterator i;
+    for (i = _callbackMap.begin(); i != _callbackMap.end(); ++i) {
+        const Trigger& t = i->first;
+        switch (t.type) {
+            case eKeyTrigger:
+                if ((t.data3 >= 0) && (t.data3 < SDL_NUM_SCANCODES)) {
+                    KeyDispatch& kd = _keyDispatch[t.data3];
+                    if (kd.count < MAX_KEYCODES_PER_SCANCODE) {
+                        kd.bindings[kd.count].callback = i->second;
+                        kd.bindings[kd.count].keycode = t.data1;
+                        kd.count++;
+                    } else {
+                        LOG_WARNING << "Too many bindings for scancode " << t.data3 << ", ignoring "
+                                    << i->second->getActionName() << endl;
+                    }
+                } else {
+                    LOG_WARNING << "Scancode out of range: " << t.data3 << endl;
+                }
+                break;
+
+            case eButtonTrigger:
+                if ((t.data1 >= 0) && (t.data1 < MAX_BUTTONS)) {
+                    _buttonDispatch[t.data1] = i->second;
+                } else {
+                    LOG_WARNING << "Button out of range: " << t.data1 << endl;
+                }
+                break;
+
+            case eMotionTrigger:
+                _motionDispatch = i->second;
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+Callback* Input::findCallback(const Trigger& trigger) {
+    switch (trigger.type) {
+        case eKeyTrigger:
+            if ((trigger.data3 >= 0) && (trigger.data3 < SDL_NUM_SCANCODES)) {
+                const KeyDispatch& kd = _keyDispatch[trigger.data3];
+                for (int i = 0; i < kd.count; i++) {
+                    if (kd.bindings[i].keycode == trigger.data1) {
+                        return kd.bindings[i].callback;
+                    }
+                }
+            }
+            break;
+
+        case eButtonTrigger:
+            if ((trigger.data1 >= 0) && (trigger.data1 < MAX_BUTTONS)) {
+                return _buttonDispatch[trigger.data1];
+            }
+            break;
+
+        case eMotionTrigger:
+            return _motionDispatch;
+
+        default:
+            break;
+    }
+    return 0;
 }
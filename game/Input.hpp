@@ -86,6 +86,10 @@ public:
 
     std::vector<TouchInfo*> getActiveTouches();
 
+    //Time of the oldest event handled since the last call, -1 if none.
+    //Used to measure input to swap latency.
+    double takeOldestEventTime(void);
+
 private:
     virtual ~Input();
     Input(void);
@@ -93,6 +97,10 @@ private:
     Input& operator=(const Input&);
 
     void bind(Trigger& t, Callback* action);
+
+    //O(1) lookup of the callback bound to a trigger, see rebuildDispatch
+    Callback* findCallback(const Trigger& trigger);
+    void rebuildDispatch(void);
     bool tryGetTrigger(Trigger& trigger, bool& isDown);
     void updateMouseSettings(void);
 
@@ -110,11 +118,28 @@ private:
 
     hash_map<Trigger, Callback*, hash<Trigger>, std::equal_to<Trigger>> _callbackMap;
 
+    //_callbackMap compiled into flat tables, rebuilt when bindings change
+    enum { MAX_BUTTONS = 10, MAX_KEYCODES_PER_SCANCODE = 4 };
+    struct KeyBinding {
+        Callback* callback;
+        int keycode;  //triggers match on scancode and keycode
+    };
+    struct KeyDispatch {
+        KeyBinding bindings[MAX_KEYCODES_PER_SCANCODE];
+        int count;
+    };
+    KeyDispatch _keyDispatch[SDL_NUM_SCANCODES];
+    Callback* _buttonDispatch[MAX_BUTTONS];
+    Callback* _motionDispatch;
+
     //mouse position [0..1]
     vec2f _mousePos;
     vec2f _mouseDelta;
+    double _mouseDeltaTime;
     float _mouseSensitivity;
 
+    double _oldestEventTime;
+
     //intercept raw input
     InterceptorI* _interceptor;
 
@@ -0,0 +1,185 @@
+// Description:
+//   Fixed pool of worker threads for data parallel loops.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include "SDL.h"
+
+#include <Trace.hpp>
+#include <Config.hpp>
+
+#include <JobPool.hpp>
+
+using namespace std;
+
+const int MAX_WORKER_THREADS = 15;
+
+JobPool::JobPool(void) :
+    _mutex(0),
+    _wake(0),
+    _done(0),
+    _job(0),
+    _count(0),
+    _grain(1),
+    _next(0),
+    _generation(0),
+    _active(0),
+    _quit(false) {
+    XTRACE();
+}
+
+JobPool::~JobPool() {
+    XTRACE();
+    stop();
+}
+
+void JobPool::init(void) {
+    stop();
+
+    int threads = -1;
+    ConfigS::instance()->getInteger("workerThreads", threads);
+    if (threads < 0) {
+        threads = SDL_GetCPUCount() - 1;
+    }
+    if (threads > MAX_WORKER_THREADS) {
+        threads = MAX_WORKER_THREADS;
+    }
+
+#if defined(EMSCRIPTEN)
+    //no pthreads in the web build
+    threads = 0;
+#endif
+
+    if (threads > 0) {
+        _mutex = SDL_CreateMutex();
+        _wake = SDL_CreateCond();
+        _done = SDL_CreateCond();
+        _quit = false;
+        _generation = 0;
+
+        for (int i = 0; i < threads; i++) {
+            SDL_Thread* thread = SDL_CreateThread(run, "JobPool", this);
+            if (!thread) {
+                LOG_WARNING << "Unable to start worker thread: " << SDL_GetError() << endl;
+                break;
+            }
+            _threads.push_back(thread);
+        }
+    }
+
+    LOG_INFO << "Worker threads: " << _threads.size() << endl;
+}
+
+void JobPool::stop(void) {
+    if (!_threads.empty()) {
+        SDL_LockMutex(_mutex);
+        _quit = true;
+        SDL_CondBroadcast(_wake);
+        SDL_UnlockMutex(_mutex);
+
+        for (size_t i = 0; i < _threads.size(); i++) {
+            SDL_WaitThread(_threads[i], 0);
+        }
+        _threads.clear();
+    }
+
+    if (_done) {
+        SDL_DestroyCond(_done);
+        _done = 0;
+    }
+    if (_wake) {
+        SDL_DestroyCond(_wake);
+        _wake = 0;
+    }
+    if (_mutex) {
+        SDL_DestroyMutex(_mutex);
+        _mutex = 0;
+    }
+}
+
+void JobPool::parallelFor(int count, int grain, const function<void(int, int)>& job) {
+    if (count <= 0) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+
+    if (_threads.empty() || (count <= grain)) {
+        job(0, count);
+        return;
+    }
+
+    SDL_LockMutex(_mutex);
+    _job = &job;
+    _count = count;
+    _grain = grain;
+    _next.store(0);
+    _active = (int)_threads.size();
+    _generation++;
+    SDL_CondBroadcast(_wake);
+    SDL_UnlockMutex(_mutex);
+
+    //help out instead of waiting idle
+    runChunks();
+
+    SDL_LockMutex(_mutex);
+    while (_active > 0) {
+        SDL_CondWait(_done, _mutex);
+    }
+    _job = 0;
+    SDL_UnlockMutex(_mutex);
+}
+
+void JobPool::runChunks(void) {
+    for (;;) {
+        int begin = _next.fetch_add(_grain);
+        if (begin >= _count) {
+            break;
+        }
+        int end = begin + _grain;
+        if (end > _count) {
+            end = _count;
+        }
+        (*_job)(begin, end);
+    }
+}
+
+int JobPool::run(void* data) {
+    static_cast<JobPool*>(data)->work();
+    return 0;
+}
+
+void JobPool::work(void) {
+    //generations start at 1, so a worker that starts late still sees the first job
+    unsigned int seen = 0;
+
+    SDL_LockMutex(_mutex);
+    for (;;) {
+        while ((_generation == seen) && !_quit) {
+            SDL_CondWait(_wake, _mutex);
+        }
+        if (_quit) {
+            break;
+        }
+        seen = _generation;
+
+        SDL_UnlockMutex(_mutex);
+        runChunks();
+        SDL_LockMutex(_mutex);
+
+        if (--_active == 0) {
+            SDL_CondSignal(_done);
+        }
+    }
+    SDL_UnlockMutex(_mutex);
+}
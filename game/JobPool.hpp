@@ -0,0 +1,69 @@
+#pragma once
+// Description:
+//   Fixed pool of worker threads for data parallel loops.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <Singleton.hpp>
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+
+//Workers and the calling thread pull fixed size chunks from a shared
+//counter until the range is used up, so a slow chunk never holds up the
+//rest. Which thread runs a chunk varies, the jobs must not depend on it.
+class JobPool {
+    friend class Singleton<JobPool>;
+
+public:
+    //reads workerThreads from config (-1 = one less than the cores, 0 = off)
+    void init(void);
+
+    int getThreadCount(void) const { return (int)_threads.size(); }
+
+    //Run job(begin, end) over [0, count) in chunks of 'grain' items and
+    //return once all of them are done. Runs inline without workers.
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& job);
+
+private:
+    ~JobPool();
+    JobPool(void);
+    JobPool(const JobPool&);
+    JobPool& operator=(const JobPool&);
+
+    static int run(void* data);
+    void work(void);
+    void runChunks(void);
+    void stop(void);
+
+    std::vector<SDL_Thread*> _threads;
+    SDL_mutex* _mutex;
+    SDL_cond* _wake;
+    SDL_cond* _done;
+
+    const std::function<void(int, int)>* _job;
+    int _count;
+    int _grain;
+    std::atomic<int> _next;
+
+    unsigned int _generation;  //bumped for every parallelFor
+    int _active;               //workers still on the current generation
+    bool _quit;
+};
+
+typedef Singleton<JobPool> JobPoolS;
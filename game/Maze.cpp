@@ -19,25 +19,22 @@ static RandomKnuth _random;
 
 //make maze
 Maze::Maze() :
-    map(0),
-    y2off(0) {}
+    map(0) {}
 
 //destroy maze
 Maze::~Maze() {
     delete[] map;
-    delete[] y2off;
 }
 
 void Maze::init(int w, int h) {
     width = w;
     height = h;
 
-    map = new Uint32[width * height];
-    y2off = new int[height];
+    delete[] map;
+    map = new MazeCell[width * height];
 
-    for (int i = 0; i < height; i++) {
-        y2off[i] = i * width;
-    }
+    _cherries.init(width * height);
+    _powerpoints.init(width * height);
 }
 
 void Maze::reset(void) {
@@ -59,6 +56,8 @@ void Maze::Create(void) {
     for (i = 0; i < width * height; i++) {
         map[i] = 0;
     }
+    _cherries.clearAll();
+    _powerpoints.clearAll();
 
     int pos = 0;
 
@@ -137,7 +136,7 @@ void Maze::Simplify(void) {
     int x, y;
     for (y = 0; y < height; y++) {
         for (x = 0; x < width; x++) {
-            switch (map[pos] & 0xf) {
+            switch (map[pos] & WALL_MASK) {
                 case 0x0e:  //DN LT RT
                     if (y != height - 1) {
                         map[pos] &= ~WallDN;
@@ -22,12 +22,13 @@
 //Note that the bit representation for the walls
 //(and other stuff) restricts what can be done in
 //derived classes, since in the end everything has to
-//fit into a 32-bit field.
+//fit into the 8-bit cell.
 //A better way might be to do the bit assignment at constructor time,
 //oh well...
 
 #include <SDL2/SDL_stdinc.h>
 #include <Trace.hpp>
+#include <BitPlane.hpp>
 
 enum MazeElements {
     // element bit representation for walls
@@ -44,14 +45,40 @@ enum MazeElements {
     POWERPOINT = 1 << 6,
 };
 
+constexpr Uint32 WALL_MASK = WallUP | WallDN | WallLT | WallRT;
+
+typedef Uint8 MazeCell;
+
+//A cell and its four neighbours, each fetched with a single load.
+//Neighbours outside the maze read as 0 (no walls, no elements).
+struct CellNeighbourhood {
+    Uint32 center;
+    Uint32 up;
+    Uint32 down;
+    Uint32 left;
+    Uint32 right;
+};
+
 class Maze {
 protected:
-    int* y2off;
-    Uint32* map;
+    MazeCell* map;
+
+    //Items also get a bit plane each, for counting and scanning without
+    //touching every cell. Kept in sync by Add/RemoveElement.
+    BitPlane _cherries;
+    BitPlane _powerpoints;
 
     int width;
     int height;
 
+    BitPlane* plane(Uint32 element) {
+        return (element == CHERRY) ? &_cherries : (element == POWERPOINT) ? &_powerpoints : 0;
+    }
+
+    const BitPlane* plane(Uint32 element) const {
+        return (element == CHERRY) ? &_cherries : (element == POWERPOINT) ? &_powerpoints : 0;
+    }
+
     void Create(void);
     void Simplify(void);
 
@@ -67,19 +94,62 @@ public:
 
     int Height(void) { return (height); }
 
+    //Checked query, for positions that may be outside the maze.
     bool isElement(int x, int y, Uint32 element) {
-        if ((x < 0) || (x >= width) || (y < 0) || (y >= height)) {
+        if (!isInside(x, y)) {
             LOG_ERROR << "isElement out of bounds " << x << "," << y << "\n";
             return false;
         }
-        return ((map[y2off[y] + x] & element) != 0);
+        return ((map[y * width + x] & element) != 0);
+    }
+
+    bool isInside(int x, int y) const {
+        return ((unsigned int)x < (unsigned int)width) && ((unsigned int)y < (unsigned int)height);
+    }
+
+    //Unchecked queries for loops that stay inside the maze. The outer walls
+    //are always set, so following open walls never leaves it.
+    Uint32 cell(int x, int y) const { return map[y * width + x]; }
+
+    //row y, Width() cells
+    const MazeCell* row(int y) const { return map + y * width; }
+
+    CellNeighbourhood neighbourhood(int x, int y) const {
+        CellNeighbourhood n;
+        const MazeCell* c = map + y * width + x;
+        n.center = *c;
+        n.up = (y > 0) ? c[-width] : 0;
+        n.down = (y < height - 1) ? c[width] : 0;
+        n.left = (x > 0) ? c[-1] : 0;
+        n.right = (x < width - 1) ? c[1] : 0;
+        return n;
+    }
+
+    void RemoveElement(int x, int y, Uint32 element) {
+        map[y * width + x] &= ~element;
+        if (BitPlane* p = plane(element)) {
+            p->clear(y * width + x);
+        }
     }
 
-    bool isInside(int x, int y) { return !((x < 0) || (x >= width) || (y < 0) || (y >= height)); }
+    void AddElement(int x, int y, Uint32 element) {
+        map[y * width + x] |= element;
+        if (BitPlane* p = plane(element)) {
+            p->set(y * width + x);
+        }
+    }
 
-    void RemoveElement(int x, int y, Uint32 element) { map[y2off[y] + x] &= ~element; }
+    //Item planes: number of cells with the item, and the first cell index
+    //(y * Width() + x) at or after 'from' that has it, -1 if none.
+    int countItems(Uint32 element) const {
+        const BitPlane* p = plane(element);
+        return p ? p->count() : 0;
+    }
 
-    void AddElement(int x, int y, Uint32 element) { map[y2off[y] + x] |= element; }
+    int findItem(Uint32 element, int from) const {
+        const BitPlane* p = plane(element);
+        return p ? p->findNext(from) : -1;
+    }
 };
 
 #endif
@@ -65,40 +65,23 @@ vec2f MazeNavigation::getNextPosition(const vec2f& itemPos, const vec2f& velocit
     float x;
     float y;
 
-    int wallIndex = 0;
-
-    vec2i p = pos;
-    x = p.x();
-    y = p.y();
-    if (pm->isElement(p.x(), p.y(), WallLT)) {
-        _vWalls[wallIndex++]->SetTransform(b2Vec2(x - 0.5f, y), 0);
-    }
-    if (pm->isElement(p.x(), p.y(), WallRT)) {
-        _vWalls[wallIndex++]->SetTransform(b2Vec2(x + 0.5f, y), 0);
-    }
-
-    p = vec2i(pos.x(), pos.y() + 1);
-    if (pm->isInside(p.x(), p.y())) {
-        x = p.x();
-        y = p.y();
-
-        if (pm->isElement(p.x(), p.y(), WallLT)) {
-            _vWalls[wallIndex++]->SetTransform(b2Vec2(x - 0.5f, y), 0);
-        }
-        if (pm->isElement(p.x(), p.y(), WallRT)) {
-            _vWalls[wallIndex++]->SetTransform(b2Vec2(x + 0.5f, y), 0);
-        }
+    //all walls around us from one fetch of the neighbourhood
+    CellNeighbourhood n = {0, 0, 0, 0, 0};
+    if (pm->isInside(pos.x(), pos.y())) {
+        n = pm->neighbourhood(pos.x(), pos.y());
     }
 
-    p = vec2i(pos.x(), pos.y() - 1);
-    if (pm->isInside(p.x(), p.y())) {
-        x = p.x();
-        y = p.y();
-
-        if (pm->isElement(p.x(), p.y(), WallLT)) {
+    //vertical walls of the cells above, at and below our position
+    const Uint32 vCells[3] = {n.center, n.down, n.up};
+    const int vOffsets[3] = {0, 1, -1};
+    int wallIndex = 0;
+    for (int i = 0; i < 3; i++) {
+        x = pos.x();
+        y = pos.y() + vOffsets[i];
+        if (vCells[i] & WallLT) {
             _vWalls[wallIndex++]->SetTransform(b2Vec2(x - 0.5f, y), 0);
         }
-        if (pm->isElement(p.x(), p.y(), WallRT)) {
+        if (vCells[i] & WallRT) {
             _vWalls[wallIndex++]->SetTransform(b2Vec2(x + 0.5f, y), 0);
         }
     }
@@ -107,39 +90,17 @@ vec2f MazeNavigation::getNextPosition(const vec2f& itemPos, const vec2f& velocit
         _vWalls[i]->SetTransform(b2Vec2(-10, -10), 0);
     }
 
+    //horizontal walls of the cells left, at and right of our position
+    const Uint32 hCells[3] = {n.center, n.left, n.right};
+    const int hOffsets[3] = {0, -1, 1};
     wallIndex = 0;
-    p = pos;
-    x = p.x();
-    y = p.y();
-    if (pm->isElement(p.x(), p.y(), WallUP)) {
-        _hWalls[wallIndex++]->SetTransform(b2Vec2(x, y - 0.5f), 0);
-    }
-    if (pm->isElement(p.x(), p.y(), WallDN)) {
-        _hWalls[wallIndex++]->SetTransform(b2Vec2(x, y + 0.5), 0);
-    }
-
-    p = vec2i(pos.x() - 1, pos.y());
-    if (pm->isInside(p.x(), p.y())) {
-        x = p.x();
-        y = p.y();
-
-        if (pm->isElement(p.x(), p.y(), WallUP)) {
-            _hWalls[wallIndex++]->SetTransform(b2Vec2(x, y - 0.5f), 0);
-        }
-        if (pm->isElement(p.x(), p.y(), WallDN)) {
-            _hWalls[wallIndex++]->SetTransform(b2Vec2(x, y + 0.5), 0);
-        }
-    }
-
-    p = vec2i(pos.x() + 1, pos.y());
-    if (pm->isInside(p.x(), p.y())) {
-        x = p.x();
-        y = p.y();
-
-        if (pm->isElement(p.x(), p.y(), WallUP)) {
+    for (int i = 0; i < 3; i++) {
+        x = pos.x() + hOffsets[i];
+        y = pos.y();
+        if (hCells[i] & WallUP) {
             _hWalls[wallIndex++]->SetTransform(b2Vec2(x, y - 0.5f), 0);
         }
-        if (pm->isElement(p.x(), p.y(), WallDN)) {
+        if (hCells[i] & WallDN) {
             _hWalls[wallIndex++]->SetTransform(b2Vec2(x, y + 0.5), 0);
         }
     }
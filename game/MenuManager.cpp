@@ -24,8 +24,13 @@
 #include "glm/ext.hpp"
 #include "gl3/ProgramManager.hpp"
 #include "gl3/Program.hpp"
+#include "gl3/MatrixStack.hpp"
+#include "gl3/StateCache.hpp"
+#include "RenderQueue.hpp"
 
 #include "Input.hpp"
+#include "Hero.hpp"
+#include "SimThread.hpp"
 #include "VideoBase.hpp"
 
 using namespace std;
@@ -42,7 +47,8 @@ MenuManager::MenuManager() :
     _angle(0.0),
     _prevAngle(0.0),
     _showSparks(true),
-    _burst("SparkBurst", 1000) {
+    _burst("SparkBurst", 1000),
+    _sparkType(-1) {
     XTRACE();
 
     updateSettings();
@@ -99,6 +105,8 @@ bool MenuManager::init(void) {
     }
 #endif
     _burst.init();
+    //the atlas has no Spark1 bitmap, the burst stays off until it does
+    //_sparkType = ParticleGroup::getParticleTypeId("Spark");
 
     return true;
 }
@@ -178,12 +186,13 @@ bool MenuManager::update(void) {
         (*i)->update();
     }
 
-    if (_showSparks) {
+    if (_showSparks && (_sparkType >= 0)) {
 #ifndef IPHONE
         GLBitmapCollection* icons = BitmapManagerS::instance()->getBitmap("bitmaps/atlas");  //"bitmaps/menuIcons");
         float iw = icons->getWidth(_pointer);
         float ih = icons->getHeight(_pointer);
 #endif
+        vec3 sparks[10];
         for (int i = 0; i < 10; i++) {
             float interpMouseX = _prevMouseX + (_mouseX - _prevMouseX) * ((9.0 - (float)i) / 9.0);
             float interpMouseY = _prevMouseY + (_mouseY - _prevMouseY) * ((9.0 - (float)i) / 9.0);
@@ -194,8 +203,9 @@ bool MenuManager::update(void) {
             float w = interpMouseX + iw;
             float h = interpMouseY - ih;
 #endif
-            _burst.newParticle("Spark", w, h, 0);
+            sparks[i] = vec3(w, h, 0);
         }
+        _burst.newParticles(_sparkType, 10, sparks);
 
         _burst.update();
     }
@@ -211,11 +221,14 @@ bool MenuManager::draw(void) {
         return true;
     }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateCache::enable(GL_BLEND);
+    StateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    RenderQueue& renderQueue = *RenderQueueS::instance();
+    renderQueue.setLayer(RenderLayer::eMenu);
 
     VideoBase& video = *VideoBaseS::instance();
-    glViewport(0, 0, video.getWidth(), video.getHeight());
+    renderQueue.addViewport(0, 0, video.getWidth(), video.getHeight());
 
 #if 0
     glEnable( GL_DEPTH_TEST);
@@ -235,18 +248,16 @@ bool MenuManager::draw(void) {
 #endif
 
     GLBitmapCollection* menuBoard = BitmapManagerS::instance()->getBitmap("bitmaps/atlas");  //"bitmaps/menuBoard");
-    menuBoard->bind();
 
     float orthoHeight = 750.0;
     float orthoWidth = 1000.0;
 
     glm::mat4 projM = glm::ortho(-0.5f, orthoWidth + 0.5f, -0.5f, orthoHeight + 0.5f, -1000.0f, 1000.0f);
     glm::mat4 modelM(1.0f);
-    glm::mat4 modelViewMatrix = projM * modelM;
-    Program* prog = ProgramManagerS::instance()->getProgram("texture");
-    prog->use();  //needed to set uniforms
-    GLint modelViewMatrixLoc = glGetUniformLocation(prog->id(), "modelViewMatrix");
-    glUniformMatrix4fv(modelViewMatrixLoc, 1, GL_FALSE, glm::value_ptr(modelViewMatrix));
+
+    //queued draw commands pick up their transform from the MatrixStack
+    MatrixStack::projection.push(projM);
+    MatrixStack::model.push(modelM);
 
     float boardScaleX = orthoWidth * 0.3 / 150.0;
     float boardScaleY = orthoHeight * 0.4 / 150.0;
@@ -272,6 +283,7 @@ bool MenuManager::draw(void) {
                              _boardOffset.y + 625, titleScale, titleScale);
     }
 
+    renderQueue.setLayer(RenderLayer::eMenuText);
     list<Selectable*>::iterator i;
     for (i = _activeSelectables.begin(); i != _activeSelectables.end(); i++) {
         _boardOffset.x = 60.0;
@@ -280,14 +292,20 @@ bool MenuManager::draw(void) {
 
     //glEnable(GL_TEXTURE_2D);
     if (_showSparks) {
+        renderQueue.setLayer(RenderLayer::eMenuParticles);
         //_burst.draw();
     }
 
+    renderQueue.setLayer(RenderLayer::eOverlay);
     GLBitmapCollection* icons = BitmapManagerS::instance()->getBitmap("bitmaps/atlas");  //"bitmaps/menuIcons");
-    icons->bind();
     icons->setColor(1.0, 1.0, 1.0, 1.0);
     icons->Draw(_pointer, _mouseX, _mouseY, 0.5, 0.5);
 
+    renderQueue.setLayer(RenderLayer::eMenuText);
+
+    MatrixStack::model.pop();
+    MatrixStack::projection.pop();
+
     return true;
 }
 
@@ -299,6 +317,7 @@ void MenuManager::reload(void) {
 }
 
 void MenuManager::turnMenuOn(void) {
+    WorldLock lock;
     SDL_SetRelativeMouseMode(SDL_FALSE);
 
     AudioS::instance()->playSample("sounds/beep");
@@ -308,6 +327,7 @@ void MenuManager::turnMenuOn(void) {
     //ask input system to forward all input to us
     InputS::instance()->enableInterceptor(this);
     GameState::stopwatch.pause();
+    HeroS::instance()->discardInput();
 
 #ifdef IPHONE
     _currentSelectable = _activeSelectables.end();
@@ -321,6 +341,7 @@ void MenuManager::turnMenuOff(void) {
         return;
     }
 
+    WorldLock lock;
     SDL_SetRelativeMouseMode(SDL_TRUE);
 
     AudioS::instance()->playSample("sounds/beep");
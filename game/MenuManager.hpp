@@ -81,6 +81,7 @@ private:
 
     bool _showSparks;
     ParticleGroup _burst;
+    int _sparkType;
 };
 
 typedef Singleton<MenuManager> MenuManagerS;
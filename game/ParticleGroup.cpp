@@ -11,21 +11,26 @@
 #include <FindHash.hpp>
 #include <Enemy.hpp>
 #include <Hero.hpp>
+#include <JobPool.hpp>
 using namespace std;
 
 hash_map<const string, ParticleType*, hash<const string>, std::equal_to<const string>> ParticleGroup::_particleTypeMap;
+vector<ParticleType*> ParticleGroup::_particleTypes;
 
 ParticleGroup::ParticleGroup(const string& groupName, int numParticles) :
     _particles(0),
+    _spawnTail(0),
     _aliveCount(0),
     _groupName(groupName),
     _numParticles(numParticles) {
     XTRACE();
     _usedList.next = 0;
+    _spawnList.next = 0;
 }
 
 ParticleGroup::~ParticleGroup() {
     XTRACE();
+    commitSpawns();
 
     LOG_INFO << _groupName << " has " << _aliveCount << " particles still alive.\n";
     ParticleInfo* p = _usedList.next;
@@ -38,8 +43,53 @@ ParticleGroup::~ParticleGroup() {
     delete[] _particles;
 }
 
+bool ParticleGroup::updateParallel(void) {
+    JobPool* pool = JobPoolS::instance();
+    if (pool->getThreadCount() == 0) {
+        return false;
+    }
+
+    _updateList.clear();
+    for (ParticleInfo* p = _usedList.next; p; p = p->next) {
+        if (!p->particle->isIndependent()) {
+            return false;
+        }
+        _updateList.push_back(p);
+    }
+
+    int count = (int)_updateList.size();
+    _updateAlive.resize(count);
+
+    ParticleInfo** particles = &_updateList[0];
+    char* alive = &_updateAlive[0];
+    pool->parallelFor(count, PARALLEL_UPDATE_GRAIN, [particles, alive](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            alive[i] = particles[i]->particle->update(particles[i]);
+        }
+    });
+
+    //unlink the dead in list order, same result as the serial update
+    ParticleInfo* prev = &_usedList;
+    for (int i = 0; i < count; i++) {
+        ParticleInfo* p = particles[i];
+        if (alive[i]) {
+            prev->next = p;
+            prev = p;
+            continue;
+        }
+
+        p->next = _freeList.next;
+        _freeList.next = p;
+        _aliveCount--;
+    }
+    prev->next = 0;
+
+    return true;
+}
+
 void ParticleGroup::reset(void) {
     XTRACE();
+    commitSpawns();
 
     //trigger particles in use to die
     ParticleInfo* p = _usedList.next;
@@ -87,6 +137,7 @@ bool ParticleGroup::init(void) {
     if (!initialized) {
         new Enemy();
         HeroS::instance();
+        Particles::Initialize();
 
         initialized = true;
     }
@@ -104,8 +155,7 @@ ParticleInfo* ParticleGroup::newParticle(const string& name, const ParticleInfo&
     return newParticle(particleType, pi);
 }
 
-ParticleInfo* ParticleGroup::newParticle(ParticleType* particleType, const ParticleInfo& pi) {
-    //    XTRACE();
+ParticleInfo* ParticleGroup::allocParticle(ParticleType* particleType) {
     ParticleInfo* p = _freeList.next;
     if (!p) {
         LOG_ERROR << _groupName << " is out of particles!" << endl;
@@ -113,26 +163,74 @@ ParticleInfo* ParticleGroup::newParticle(ParticleType* particleType, const Parti
     }
 
     _freeList.next = p->next;
-    p->next = _usedList.next;
-    _usedList.next = p;
+    p->next = _spawnList.next;
+    if (!_spawnList.next) {
+        _spawnTail = p;
+    }
+    _spawnList.next = p;
 
     p->particle = particleType;
+    p->payload = 0;
+    _aliveCount++;
+
+    return p;
+}
+
+ParticleInfo* ParticleGroup::newParticle(ParticleType* particleType, const ParticleInfo& pi) {
+    //    XTRACE();
+    return spawnFrom(particleType, pi, 0);
+}
+
+ParticleInfo* ParticleGroup::newParticle(const string& name, const ParticleInfo& pi, const string& text) {
+    //    XTRACE();
+    ParticleType* particleType = getParticleType(name);
+    if (!particleType) {
+        LOG_ERROR << "Unknown particleType [" << name << "]" << endl;
+        return 0;
+    }
+    return spawnFrom(particleType, pi, &text);
+}
+
+ParticleInfo* ParticleGroup::newParticle(ParticleType* particleType, const ParticleInfo& pi, const string& text) {
+    //    XTRACE();
+    return spawnFrom(particleType, pi, &text);
+}
+
+ParticleInfo* ParticleGroup::spawnFrom(ParticleType* particleType, const ParticleInfo& pi, const string* text) {
+    ParticleInfo* p = allocParticle(particleType);
+    if (!p) {
+        return 0;
+    }
+
     p->position = pi.position;
     p->velocity = pi.velocity;
     p->extra = pi.extra;
     p->color = pi.color;
-    p->text = pi.text;
     p->damage = pi.damage;
-    p->related = pi.related;
+
+    if (text) {
+        if (_payloads.empty()) {
+            _payloads.resize(_numParticles);
+        }
+        p->payload = &_payloads[p - _particles];
+        p->payload->text = *text;
+        p->payload->related = 0;
+    }
 
     //particle initializes particle info
     particleType->init(p);
 
-    _aliveCount++;
-
     return p;
 }
 
+ParticleInfo* ParticleGroup::newParticle(int typeId, const ParticleInfo& pi) {
+    ParticleType* particleType = getParticleType(typeId);
+    if (!particleType) {
+        return 0;
+    }
+    return newParticle(particleType, pi);
+}
+
 ParticleInfo* ParticleGroup::newParticle(const string& name, float x, float y, float z) {
     //    XTRACE();
     ParticleType* particleType = getParticleType(name);
@@ -145,17 +243,11 @@ ParticleInfo* ParticleGroup::newParticle(const string& name, float x, float y, f
 
 ParticleInfo* ParticleGroup::newParticle(ParticleType* particleType, float x, float y, float z) {
     //    XTRACE();
-    ParticleInfo* p = _freeList.next;
+    ParticleInfo* p = allocParticle(particleType);
     if (!p) {
-        LOG_ERROR << _groupName << " is out of particles!" << endl;
         return 0;
     }
 
-    _freeList.next = p->next;
-    p->next = _usedList.next;
-    _usedList.next = p;
-
-    p->particle = particleType;
     p->position.x = x;
     p->position.y = y;
     p->position.z = z;
@@ -163,11 +255,53 @@ ParticleInfo* ParticleGroup::newParticle(ParticleType* particleType, float x, fl
     //particle initializes particle info
     particleType->init(p);
 
-    _aliveCount++;
-
     return p;
 }
 
+ParticleInfo* ParticleGroup::newParticle(int typeId, float x, float y, float z) {
+    ParticleType* particleType = getParticleType(typeId);
+    if (!particleType) {
+        return 0;
+    }
+    return newParticle(particleType, x, y, z);
+}
+
+int ParticleGroup::newParticles(const string& name, int count, const vec3* positions) {
+    //    XTRACE();
+    ParticleType* particleType = getParticleType(name);
+    if (!particleType) {
+        LOG_ERROR << "Unknown particleType [" << name << "]" << endl;
+        return 0;
+    }
+    return newParticles(particleType, count, positions);
+}
+
+int ParticleGroup::newParticles(int typeId, int count, const vec3* positions) {
+    ParticleType* particleType = getParticleType(typeId);
+    if (!particleType) {
+        return 0;
+    }
+    return newParticles(particleType, count, positions);
+}
+
+int ParticleGroup::newParticles(ParticleType* particleType, int count, const vec3* positions) {
+    //    XTRACE();
+    _batch.clear();
+    for (int i = 0; i < count; i++) {
+        ParticleInfo* p = allocParticle(particleType);
+        if (!p) {
+            break;
+        }
+        p->position = positions[i];
+        _batch.push_back(p);
+    }
+
+    if (!_batch.empty()) {
+        particleType->initBatch(&_batch[0], (int)_batch.size());
+    }
+    return (int)_batch.size();
+}
+
 static inline bool hasRadiusCollision(const float& minDist, const vec3& pos1, const vec3& pos2) {
     float d2 = minDist;
     d2 *= d2;
@@ -229,11 +363,38 @@ void ParticleGroup::addParticleType(ParticleType* particleType) {
     if (particleType) {
         LOG_INFO << "New Particle type: [" << particleType->name() << "]" << endl;
 
+        //a type registered again under the same name keeps its id
+        ParticleType* previous = findHash<const string>(particleType->name(), _particleTypeMap);
+        if (previous) {
+            particleType->_id = previous->_id;
+            _particleTypes[particleType->_id] = particleType;
+        } else {
+            particleType->_id = (int)_particleTypes.size();
+            _particleTypes.push_back(particleType);
+        }
+
         _particleTypeMap[particleType->name()] = particleType;
     }
 }
 
-ParticleType* ParticleGroup::getParticleType(const string particleTypeName) {
+int ParticleGroup::getParticleTypeId(const string& particleTypeName) {
+    ParticleType* particleType = findHash<const string>(particleTypeName, _particleTypeMap);
+    if (!particleType) {
+        LOG_ERROR << "ParticleGroup never heard of a " << particleTypeName << " before!" << endl;
+        return -1;
+    }
+    return particleType->id();
+}
+
+ParticleType* ParticleGroup::getParticleType(int typeId) {
+    if ((unsigned int)typeId >= _particleTypes.size()) {
+        LOG_ERROR << "Unknown particle type id " << typeId << endl;
+        return 0;
+    }
+    return _particleTypes[typeId];
+}
+
+ParticleType* ParticleGroup::getParticleType(const string& particleTypeName) {
     //    XTRACE();
     ParticleType* particleType = findHash<const string>(particleTypeName, _particleTypeMap);
     if (!particleType) {
@@ -5,6 +5,7 @@
 // Copyright (C) 2008 Frank Becker
 //
 #include <string>
+#include <vector>
 #include <hashMap.hpp>
 
 #include <HashString.hpp>
@@ -27,8 +28,42 @@ public:
     ParticleInfo* newParticle(const std::string& name, const ParticleInfo& pi);
     ParticleInfo* newParticle(ParticleType* particleType, const ParticleInfo& pi);
 
+    //with 'text' in the particle's payload, set before init() runs
+    ParticleInfo* newParticle(const std::string& name, const ParticleInfo& pi, const std::string& text);
+    ParticleInfo* newParticle(ParticleType* particleType, const ParticleInfo& pi, const std::string& text);
+
+    //by type id, an array lookup instead of hashing the name for every spawn
+    ParticleInfo* newParticle(int typeId, float x, float y, float z);
+    ParticleInfo* newParticle(int typeId, const ParticleInfo& pi);
+
+    //Spawn 'count' particles of one type at the given positions with a single
+    //initBatch() call. Returns how many there was room for.
+    int newParticles(const std::string& name, int count, const vec3* positions);
+    int newParticles(ParticleType* particleType, int count, const vec3* positions);
+    int newParticles(int typeId, int count, const vec3* positions);
+
+    //New particles wait on the spawn list until the next update() or
+    //commitSpawns(), so spawning from update() or hit() never changes the list
+    //being walked. Particles die by failing update(), which unlinks them.
+    void commitSpawns(void) {
+        if (!_spawnList.next) {
+            return;
+        }
+        //newest first, same order as linking them in one at a time
+        _spawnTail->next = _usedList.next;
+        _usedList.next = _spawnList.next;
+        _spawnList.next = 0;
+        _spawnTail = 0;
+    }
+
     void update(void) {
         //    XTRACE();
+        commitSpawns();
+
+        if ((_aliveCount >= PARALLEL_UPDATE_MIN) && updateParallel()) {
+            return;
+        }
+
         ParticleInfo* prev = &_usedList;
         ParticleInfo* p = _usedList.next;
         while (p) {
@@ -60,6 +95,23 @@ public:
         }
     }
 
+    //Append copies of the live particles for drawing elsewhere. Payloads are
+    //copied too, payloads must have room for them. See RenderSnapshot.
+    void snapshot(std::vector<ParticleInfo>& particles, std::vector<ParticlePayload>& payloads) {
+        ParticleInfo* p = _usedList.next;
+        while (p) {
+            particles.push_back(*p);
+            ParticleInfo& copy = particles.back();
+            copy.next = 0;
+            if (p->payload) {
+                payloads.push_back(*p->payload);
+                payloads.back().related = 0;
+                copy.payload = &payloads.back();
+            }
+            p = p->next;
+        }
+    }
+
     bool init(void);
     void reset(void);
 
@@ -70,6 +122,10 @@ public:
 
     static void addParticleType(ParticleType* particleType);
 
+    //Id of a registered type, -1 if there is none by that name. Look it up
+    //once after the types are registered (the first group init) and keep it.
+    static int getParticleTypeId(const std::string& particleTypeName);
+
     static void destroyParticleTypes(void) {
         hash_map<const std::string, ParticleType*, hash<const std::string>>::const_iterator ci;
         for (ci = _particleTypeMap.begin(); ci != _particleTypeMap.end(); ci++) {
@@ -81,22 +137,44 @@ public:
         }
 
         _particleTypeMap.clear();
+        _particleTypes.clear();
     }
 
 private:
     ParticleGroup(const ParticleGroup&);
     ParticleGroup& operator=(const ParticleGroup&);
 
-    ParticleType* getParticleType(const std::string particleTypeName);
+    ParticleType* getParticleType(const std::string& particleTypeName);
+    ParticleType* getParticleType(int typeId);
+
+    //take a particle off the free list and queue it for spawning
+    ParticleInfo* allocParticle(ParticleType* particleType);
+    ParticleInfo* spawnFrom(ParticleType* particleType, const ParticleInfo& pi, const std::string* text);
+
+    //Update on the JobPool if every live particle is independent. Returns
+    //false, without updating anything, if it can't.
+    bool updateParallel(void);
+    static const int PARALLEL_UPDATE_MIN = 256;
+    static const int PARALLEL_UPDATE_GRAIN = 128;
 
     //All Particle manager share the particleTypeMap
     static hash_map<const std::string, ParticleType*, hash<const std::string>, std::equal_to<const std::string>>
         _particleTypeMap;
+    //the same types indexed by id
+    static std::vector<ParticleType*> _particleTypes;
 
     ParticleInfo* _particles;
 
     ParticleInfo _freeList;
     ParticleInfo _usedList;
+    ParticleInfo _spawnList;
+    ParticleInfo* _spawnTail;
+
+    std::vector<ParticleInfo*> _batch;
+    std::vector<ParticlePayload> _payloads;  //by slot, sized on first use
+
+    std::vector<ParticleInfo*> _updateList;
+    std::vector<char> _updateAlive;
 
     int _aliveCount;
     std::string _groupName;
@@ -50,12 +50,25 @@ void ParticleGroupManager::reset(void) {
     }
 }
 
-void ParticleGroupManager::draw(void) {
+void ParticleGroupManager::snapshot(vector<ParticleInfo>& particles, vector<ParticlePayload>& payloads) {
     XTRACE();
+    particles.clear();
+    payloads.clear();
+
+    //the particles keep pointers into payloads, it must not grow while copying
+    payloads.reserve(getAliveCount());
 
     list<ParticleGroup*>::iterator i;
     for (i = _particleGroupList.begin(); i != _particleGroupList.end(); i++) {
-        (*i)->draw();
+        (*i)->snapshot(particles, payloads);
+    }
+}
+
+void ParticleGroupManager::draw(vector<ParticleInfo>& particles) {
+    XTRACE();
+
+    for (size_t i = 0; i < particles.size(); i++) {
+        particles[i].particle->draw(&particles[i]);
     }
 }
 
@@ -74,6 +87,11 @@ bool ParticleGroupManager::update(void) {
         lpg->group1->detectCollisions(lpg->group2);
     }
 
+    //spawns from the hits above join in time to be drawn
+    for (i = _particleGroupList.begin(); i != _particleGroupList.end(); i++) {
+        (*i)->commitSpawns();
+    }
+
     return true;
 }
 
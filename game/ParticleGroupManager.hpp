@@ -6,12 +6,15 @@
 //
 #include <string>
 #include <list>
+#include <vector>
 #include <hashMap.hpp>
 
 #include <HashString.hpp>
 #include <Singleton.hpp>
 
 class ParticleGroup;
+struct ParticleInfo;
+struct ParticlePayload;
 
 class ParticleGroupManager {
     friend class Singleton<ParticleGroupManager>;
@@ -19,9 +22,13 @@ class ParticleGroupManager {
 public:
     bool init(void);
     void reset(void);
-    void draw(void);
     bool update(void);
 
+    //copy the live particles of all groups, see RenderSnapshot
+    void snapshot(std::vector<ParticleInfo>& particles, std::vector<ParticlePayload>& payloads);
+    //draw particles copied by snapshot()
+    void draw(std::vector<ParticleInfo>& particles);
+
     void addGroup(const std::string& groupName, int groupSize);
     void addLink(const std::string& group1, const std::string& group2);
     ParticleGroup* getParticleGroup(const std::string& groupName);
@@ -8,6 +8,18 @@
 #include <Point.hpp>
 
 class ParticleType;
+struct ParticleInfo;
+
+//Data only a few particle types use. It lives in a side table of the
+//particle's group, indexed by slot, so the records the update and draw
+//loops walk stay small.
+struct ParticlePayload {
+    std::string text;  //some text associated with the particle
+
+    Point3D points[4];  //E.g.: Bezier curve data
+
+    ParticleInfo* related;  //used for swarm leader
+};
 
 struct ParticleInfo {
     //values for current game step position
@@ -22,17 +34,19 @@ struct ParticleInfo {
     vec3 prevColor;
     vec3 prevExtra;
 
-    Point3D points[4];  //E.g.: Bezier curve data
-
     float tod;     //time of death
     float radius;  //radius for collision detection
 
     int damage;  //damage the particle inflicts
 
-    std::string text;  //some text associated with the particle
-
     ParticleInfo* next;
     ParticleType* particle;
 
-    ParticleInfo* related;  //used for swarm leader
+    ParticlePayload* payload;  //0 unless spawned with one
 };
+
+//the particle's text, empty if it has no payload
+inline const std::string& particleText(const ParticleInfo* p) {
+    static const std::string none;
+    return p->payload ? p->payload->text : none;
+}
@@ -12,7 +12,8 @@
 using namespace std;
 
 ParticleType::ParticleType(const string& particleName, bool manage) :
-    _name(particleName) {
+    _name(particleName),
+    _id(-1) {
     XTRACE();
     if (manage) {
         ParticleGroup::addParticleType(this);
@@ -18,6 +18,13 @@ public:
     virtual bool update(ParticleInfo* p) = 0;
     virtual void draw(ParticleInfo* p) = 0;
 
+    //init for a batch of new particles, see ParticleGroup::newParticles
+    virtual void initBatch(ParticleInfo** particles, int count) {
+        for (int i = 0; i < count; i++) {
+            init(particles[i]);
+        }
+    }
+
     virtual void hit(ParticleInfo* p, int /*damage*/, int radIndex = 0) {
         p->tod = 0;
         radIndex = 0;
@@ -25,6 +32,10 @@ public:
 
     virtual void hit(ParticleInfo* p, ParticleInfo* p2, int radIndex = 0) { hit(p, p2->damage, radIndex); }
 
+    //True if update() touches nothing but the particle's own ParticleInfo,
+    //so particles of this type may be updated on worker threads.
+    virtual bool isIndependent(void) { return false; }
+
     virtual int getRadiiCount(void) { return 1; }
 
     virtual float getRadius(int /*radIndex*/) { return 0.0f; }
@@ -36,12 +47,18 @@ public:
 
     const std::string& name(void) { return _name; }
 
+    //index into the registered types, see ParticleGroup::getParticleTypeId
+    int id(void) const { return _id; }
+
 protected:
     void updatePrevs(ParticleInfo* p);
     void interpolate(ParticleInfo* p, ParticleInfo& pi);
     void interpolateOther(ParticleInfo* p, ParticleInfo& pi);
 
 private:
+    friend class ParticleGroup;
+
     void interpolateImpl(ParticleInfo* p, ParticleInfo& pi, const float& gf);
     const std::string _name;
+    int _id;
 };
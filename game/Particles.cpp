@@ -37,6 +37,26 @@ static RandomKnuth _random;
 
 //------------------------------------------------------------------------------
 
+void Particles::Initialize(void) {
+    XTRACE();
+    static bool initialized = false;
+    if (initialized) {
+        return;
+    }
+
+    //ParticleType registers itself with ParticleGroup
+    new SmokePuff();
+    new MiniSmoke();
+    new Spark();
+    new FireSpark("FireSpark1");
+    new StatusMessage();
+    new ScoreHighlight();
+
+    initialized = true;
+}
+
+//------------------------------------------------------------------------------
+
 float getPseudoRadius(Model* model) {
     //if most of the movement is vertical, width represents the radius
     //most realisticly (for non square objs).
@@ -78,6 +98,10 @@ SingleBitmapParticle::SingleBitmapParticle(const string& name, const char* bitma
     XTRACE();
     string bmName(bitmapName);
     _bmIndex = _bitmaps->getIndex(bmName);
+    if (_bmIndex < 0) {
+        LOG_WARNING << "No bitmap [" << bmName << "] in atlas, using cherrySmall for " << name << endl;
+        _bmIndex = _bitmaps->getIndex("cherrySmall");
+    }
 
     _bmHalfWidth = (float)(_bitmaps->getWidth(_bmIndex)) / 2.0f;
     _bmHalfHeight = (float)(_bitmaps->getHeight(_bmIndex)) / 2.0f;
@@ -101,12 +125,12 @@ SmokePuff::~SmokePuff() {
 
 void SmokePuff::init(ParticleInfo* p) {
     XTRACE();
-    p->velocity.x = 0.0f * GAME_STEP_SCALE;
-    p->velocity.y = 0.27f * GAME_STEP_SCALE;
-    p->velocity.z = 0.0f * GAME_STEP_SCALE;
+    p->velocity.x = 0.0f * GameState::stepScale;
+    p->velocity.y = 0.27f * GameState::stepScale;
+    p->velocity.z = 0.0f * GameState::stepScale;
 
-    p->extra.x = 0.025f * GAME_STEP_SCALE;
-    p->extra.y = 0.004f * GAME_STEP_SCALE;
+    p->extra.x = 0.025f;
+    p->extra.y = 0.004f * GameState::stepScale;
     p->extra.z = 0.36f;
 
     //init previous values for interpolation
@@ -137,31 +161,8 @@ void SmokePuff::draw(ParticleInfo* p) {
     ParticleInfo pi;
     interpolate(p, pi);
 
-    //glEnable(GL_TEXTURE_2D);
-    //glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
-
-    glPushMatrix();
-
-    float shiftX = _bmHalfWidth * pi.extra.x;
-    float shiftY = _bmHalfHeight * pi.extra.x;
-    glTranslatef(pi.position.x - shiftX, pi.position.y - shiftY, pi.position.z);
-
-    //rotate towards the camera
-    //CameraS::instance()->billboard();
-
-    //	LOG_ERROR << pi.extra.x << endl;
-    //glColor4f(1.0,1.0,1.0, pi.extra.z);
-
-    bindTexture();
     _bitmaps->setColor(1.0, 1.0, 1.0, pi.extra.z);
-    _bitmaps->Draw(_bmIndex, 0, 0, pi.extra.x, pi.extra.x);
-
-    glPopMatrix();
-
-    glEnable(GL_DEPTH_TEST);
-    //glEnable(GL_LIGHTING);
-    //glDisable(GL_TEXTURE_2D);
+    _bitmaps->DrawInstanced(_bmIndex, pi.position.x, pi.position.y, pi.extra.x, pi.extra.x, pi.position.z);
 }
 
 //------------------------------------------------------------------------------
@@ -178,8 +179,8 @@ MiniSmoke::~MiniSmoke() {
 void MiniSmoke::init(ParticleInfo* p) {
     XTRACE();
 
-    p->extra.x = 0.020f * GAME_STEP_SCALE;
-    p->extra.y = 0.002f * GAME_STEP_SCALE;
+    p->extra.x = 0.020f;
+    p->extra.y = 0.002f * GameState::stepScale;
     p->extra.z = 0.80f;
 
     //init previous values for interpolation
@@ -210,30 +211,8 @@ void MiniSmoke::draw(ParticleInfo* p) {
     ParticleInfo pi;
     interpolate(p, pi);
 
-    glEnable(GL_TEXTURE_2D);
-    glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
-
-    glPushMatrix();
-
-    float shiftX = _bmHalfWidth * pi.extra.x;
-    float shiftY = _bmHalfHeight * pi.extra.x;
-    glTranslatef(pi.position.x - shiftX, pi.position.y - shiftY, pi.position.z);
-
-    //rotate towards the camera
-    //CameraS::instance()->billboard();
-
-    //	LOG_ERROR << pi.extra.x << endl;
-    glColor4f(1.0, 1.0, 1.0, pi.extra.z);
-
-    bindTexture();
-    _bitmaps->Draw(_bmIndex, 0, 0, pi.extra.x, pi.extra.x);
-
-    glPopMatrix();
-
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
+    _bitmaps->setColor(1.0, 1.0, 1.0, pi.extra.z);
+    _bitmaps->DrawInstanced(_bmIndex, pi.position.x, pi.position.y, pi.extra.x, pi.extra.x, pi.position.z);
 }
 
 //------------------------------------------------------------------------------
@@ -249,11 +228,11 @@ Spark::~Spark() {
 
 void Spark::init(ParticleInfo* p) {
     XTRACE();
-    p->velocity.x = (float)(_random.random() & 0xf) * 0.82f * GAME_STEP_SCALE;
-    p->velocity.y = -(float)(_random.random() & 0xf) * 0.62f * GAME_STEP_SCALE;
-    p->velocity.z = 0.0f * GAME_STEP_SCALE;
+    p->velocity.x = (float)(_random.random() & 0xf) * 0.82f * GameState::stepScale;
+    p->velocity.y = -(float)(_random.random() & 0xf) * 0.62f * GameState::stepScale;
+    p->velocity.z = 0.0f * GameState::stepScale;
 
-    p->extra.x = 0.10f * GAME_STEP_SCALE;
+    p->extra.x = 0.10f;
     //    p->extra.z = 0.36;
 
     //init previous values for interpolation
@@ -265,7 +244,8 @@ bool Spark::update(ParticleInfo* p) {
     //update previous values for interpolation
     updatePrevs(p);
 
-    p->velocity.y -= 0.8f * GAME_STEP_SCALE;
+    //velocity is per step, so the change per step scales twice
+    p->velocity.y -= 0.8f * GameState::stepScale * GameState::stepScale;
 
     p->extra.z = 0.9f - p->extra.x;
     //if alpha reaches 0, we can die
@@ -273,7 +253,7 @@ bool Spark::update(ParticleInfo* p) {
         return false;
     }
 
-    p->extra.x += 0.025f * GAME_STEP_SCALE;
+    p->extra.x += 0.025f * GameState::stepScale;
 
     p->position.x += p->velocity.x;
     p->position.y += p->velocity.y;
@@ -290,11 +270,8 @@ void Spark::draw(ParticleInfo* p) {
     ParticleInfo pi;
     interpolateOther(p, pi);
 
-    //glColor4f(1.0,1.0,1.0, pi.extra.z);
-
-    bindTexture();
     _bitmaps->setColor(1.0, 1.0, 1.0, pi.extra.z);
-    _bitmaps->DrawC(_bmIndex, pi.position.x, pi.position.y, 1.0, 1.0);
+    _bitmaps->DrawInstanced(_bmIndex, pi.position.x, pi.position.y, 1.0, 1.0);
 }
 
 //------------------------------------------------------------------------------
@@ -310,11 +287,11 @@ FireSpark::~FireSpark() {
 
 void FireSpark::init(ParticleInfo* p) {
     XTRACE();
-    p->velocity.x = (float)((_random.random() & 0xff) - 0x80) * 0.0010f * GAME_STEP_SCALE;
-    p->velocity.y = (float)((_random.random() & 0xff) - 0x80) * 0.0010f * GAME_STEP_SCALE;
-    p->velocity.z = 0.0f * GAME_STEP_SCALE;
+    p->velocity.x = (float)((_random.random() & 0xff) - 0x80) * 0.0010f * GameState::stepScale;
+    p->velocity.y = (float)((_random.random() & 0xff) - 0x80) * 0.0010f * GameState::stepScale;
+    p->velocity.z = 0.0f * GameState::stepScale;
 
-    p->extra.x = 0.10f * GAME_STEP_SCALE;
+    p->extra.x = 0.10f;
     //    p->extra.z = 0.36;
 
     //init previous values for interpolation
@@ -326,7 +303,7 @@ bool FireSpark::update(ParticleInfo* p) {
     //update previous values for interpolation
     updatePrevs(p);
 
-    //    p->velocity.y -= 0.8 * GAME_STEP_SCALE;
+    //    p->velocity.y -= 0.8 * GameState::stepScale;
 
     p->extra.z = 0.9f - p->extra.x;
     //if alpha reaches 0, we can die
@@ -334,7 +311,7 @@ bool FireSpark::update(ParticleInfo* p) {
         return false;
     }
 
-    p->extra.x += 0.10f * GAME_STEP_SCALE;
+    p->extra.x += 0.10f * GameState::stepScale;
 
     p->position.x += p->velocity.x;
     p->position.y += p->velocity.y;
@@ -347,30 +324,8 @@ void FireSpark::draw(ParticleInfo* p) {
     ParticleInfo pi;
     interpolate(p, pi);
 
-    glEnable(GL_TEXTURE_2D);
-    glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
-
-    glPushMatrix();
-
-    glTranslatef(pi.position.x, pi.position.y, pi.position.z);
-
-    //rotate towards the camera
-    //CameraS::instance()->billboard();
-
-    glColor4f(1.0, 1.0, 1.0, p->extra.z);
-
-    bindTexture();
-
-    //    glRotatef( pi.extra.y, 0,0,1);
-
-    _bitmaps->DrawC(_bmIndex, 0, 0, 0.2f, 0.2f);
-
-    glPopMatrix();
-
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
+    _bitmaps->setColor(1.0, 1.0, 1.0, p->extra.z);
+    _bitmaps->DrawInstanced(_bmIndex, pi.position.x, pi.position.y, 0.2f, 0.2f, pi.position.z);
 }
 
 //------------------------------------------------------------------------------
@@ -390,12 +345,12 @@ StatusMessage::~StatusMessage() {
 
 void StatusMessage::init(ParticleInfo* p) {
     //    XTRACE();
-    p->velocity.x = -1.0f * GAME_STEP_SCALE;
+    p->velocity.x = -1.0f * GameState::stepScale;
 
-    p->extra.x = _smallFont->GetWidth(p->text.c_str(), 0.1f);
+    p->extra.x = _smallFont->GetWidth(particleText(p).c_str(), 0.1f);
     p->position.x = 70.0f;
 
-    LOG_INFO << "StatusMsg = [" << p->text << "] " /*<< p->position.y*/ << endl;
+    LOG_INFO << "StatusMsg = [" << particleText(p) << "] " /*<< p->position.y*/ << endl;
 
     p->tod = -1;
 
@@ -422,20 +377,8 @@ void StatusMessage::draw(ParticleInfo* p) {
     ParticleInfo pi;
     interpolate(p, pi);
 
-    glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
-
-    glPushMatrix();
-
-    glTranslatef(pi.position.x, pi.position.y, pi.position.z);
-
-    glColor4f(p->color.x, p->color.y, p->color.z, 0.8f);
-    _smallFont->DrawString(p->text.c_str(), 0, 0, p->extra.y, p->extra.z);
-
-    glPopMatrix();
-
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHTING);
+    _smallFont->setColor(p->color.x, p->color.y, p->color.z, 0.8f);
+    _smallFont->DrawString(particleText(p).c_str(), pi.position.x, pi.position.y, p->extra.y, p->extra.z);
 }
 
 //------------------------------------------------------------------------------
@@ -455,11 +398,11 @@ ExplosionPiece::~ExplosionPiece()
 void ExplosionPiece::init( ParticleInfo *p)
 {
 //    XTRACE();
-    p->velocity.x = (float)((_random.random()&0xff)-128)*0.002f* GAME_STEP_SCALE;
-    p->velocity.y = (float)((_random.random()&0xff)-128)*0.002f* GAME_STEP_SCALE;
-    p->velocity.z = (float)((_random.random()&0xff)-128)*0.002f* GAME_STEP_SCALE;
+    p->velocity.x = (float)((_random.random()&0xff)-128)*0.002f* GameState::stepScale;
+    p->velocity.y = (float)((_random.random()&0xff)-128)*0.002f* GameState::stepScale;
+    p->velocity.z = (float)((_random.random()&0xff)-128)*0.002f* GameState::stepScale;
 
-    p->extra.x = ((float)(_random.random()%90)-45.0f)*0.1f * GAME_STEP_SCALE;
+    p->extra.x = ((float)(_random.random()%90)-45.0f)*0.1f * GameState::stepScale;
     p->extra.y = 1.0f;
     p->tod = -1;
 
@@ -475,7 +418,7 @@ bool ExplosionPiece::update( ParticleInfo *p)
     //update previous values for interpolation
     updatePrevs(p);
 
-    p->extra.y -= 0.03f * GAME_STEP_SCALE;
+    p->extra.y -= 0.03f * GameState::stepScale;
     if( p->extra.y <= 0) return false;
 
     p->extra.z += p->extra.x;
@@ -518,9 +461,9 @@ ScoreHighlight::ScoreHighlight(void) :
 ScoreHighlight::~ScoreHighlight() {}
 
 void ScoreHighlight::init(ParticleInfo* p) {
-    p->velocity.x = (float)((_random.random() & 0xff) - 168) * 0.003f * GAME_STEP_SCALE;
-    p->velocity.y = (float)((_random.random() & 0xff) - 128) * 0.002f * GAME_STEP_SCALE;
-    p->velocity.z = (float)((_random.random() & 0xff) - 128) * 0.002f * GAME_STEP_SCALE;
+    p->velocity.x = (float)((_random.random() & 0xff) - 168) * 0.003f * GameState::stepScale;
+    p->velocity.y = (float)((_random.random() & 0xff) - 128) * 0.002f * GameState::stepScale;
+    p->velocity.z = (float)((_random.random() & 0xff) - 128) * 0.002f * GameState::stepScale;
 
     p->extra.x = _random.rangef0_1() * 40.0f - 20.0f;
     p->extra.y = 0.05f;
@@ -537,14 +480,14 @@ bool ScoreHighlight::update(ParticleInfo* p) {
     //update previous values for interpolation
     updatePrevs(p);
 
-    p->extra.z -= 0.02f * GAME_STEP_SCALE;
+    p->extra.z -= 0.02f * GameState::stepScale;
     //if alpha reaches 0, we can die
     if (p->extra.z < 0) {
         return false;
     }
 
-    p->extra.x += 1.00f * GAME_STEP_SCALE;
-    p->extra.y += 0.005f * GAME_STEP_SCALE;
+    p->extra.x += 1.00f * GameState::stepScale;
+    p->extra.y += 0.005f * GameState::stepScale;
 
     p->position.x += p->velocity.x;
     p->position.y += p->velocity.y;
@@ -558,24 +501,8 @@ void ScoreHighlight::draw(ParticleInfo* p) {
     ParticleInfo pi;
     interpolate(p, pi);
 
-    glDisable(GL_LIGHTING);
-    glDisable(GL_DEPTH_TEST);
-
-    glPushMatrix();
-
-    glTranslatef(pi.position.x, pi.position.y, pi.position.z);
-
-    //rotate towards the camera
-    //CameraS::instance()->billboard();
-
-    //    glRotatef( pi.extra.x, 0,0,1);
-
-    glColor4f(p->color.x, p->color.y, p->color.z, pi.extra.z);
-    _font->DrawString(p->text.c_str(), 0, 0, pi.extra.y, pi.extra.y);
-    glPopMatrix();
-
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHTING);
+    _font->setColor(p->color.x, p->color.y, p->color.z, pi.extra.z);
+    _font->DrawString(particleText(p).c_str(), pi.position.x, pi.position.y, pi.extra.y, pi.extra.y);
 }
 
 //------------------------------------------------------------------------------
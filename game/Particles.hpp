@@ -24,6 +24,8 @@ public:
     virtual bool update(ParticleInfo* p) = 0;
     virtual void draw(ParticleInfo* p) = 0;
 
+    virtual bool isIndependent(void) { return true; }
+
     static void bindTexture(void) { _bitmaps->bind(); }
 
 protected:
@@ -128,6 +130,8 @@ public:
     virtual bool update(ParticleInfo* p);
     virtual void draw(ParticleInfo* p);
 
+    virtual bool isIndependent(void) { return true; }
+
 protected:
     vec3 _color;
     std::string _value;
@@ -14,6 +14,7 @@
 #include <Trace.hpp>
 #include <RandomKnuth.hpp>
 #include <PuckMaze.hpp>
+#include <RenderSnapshot.hpp>
 
 #include "GLVertexBufferObject.hpp"
 
@@ -25,25 +26,26 @@ using namespace std;
 
 static RandomKnuth _random;
 
+//unique across maze instances, so a snapshot never matches the wrong texture
+static int _lastWallsSerial = 0;
+
 //make new maze and add elements
 PuckMaze::PuckMaze(void) :
-    _maze(0),
     _points(0),
-    _cellSize(4),
-    _cellBuf(0) {
+    _maze(0),
+    _textureSerial(0),
+    _wallsSerial(0),
+    _cellSize(4) {
     init(10, 10, 5);
 }
 
 PuckMaze::~PuckMaze() {
-    delete[] _cellBuf;
     delete _maze;
 }
 
 void PuckMaze::init(int w, int h, int cellSize) {
     LOG_INFO << "Maze size: " << w << "x" << h << "\n";
     _cellSize = cellSize;
-    delete[] _cellBuf;
-    _cellBuf = new char[_cellSize * _cellSize];
     Maze::init(w, h);
     reset();
 }
@@ -54,21 +56,49 @@ void PuckMaze::AddPoints(void) {
     for (i = 0; i < width * height; i++) {
         map[i] |= CHERRY;
     }
+    _cherries.setAll();
     _points = width * height;
 }
 
 void PuckMaze::AddPowerpoints(int numPoints) {
     for (int i = 0; i < numPoints; i++) {
         int pos = _random.random() % (width * height);
-        map[pos] |= POWERPOINT;
+        AddElement(pos % width, pos / width, POWERPOINT);
+    }
+}
+
+bool PuckMaze::verifyPoints(void) {
+    int cherries = _cherries.count();
+    if (cherries == _points) {
+        return true;
     }
+
+    LOG_ERROR << "Point count " << _points << " does not match " << cherries << " cherries, fixing.\n";
+    _points = cherries;
+    return false;
 }
 
 //redo the maze
 void PuckMaze::reset(void) {
     Maze::reset();
     AddPoints();
-    UpdateTexture();
+    _wallsSerial = ++_lastWallsSerial;
+}
+
+void PuckMaze::snapshot(MazeSnapshot& s) const {
+    s.width = width;
+    s.height = height;
+    s.cellSize = _cellSize;
+    s.points = _points;
+    s.wallsSerial = _wallsSerial;
+    s.cells.assign(map, map + width * height);
+    s.cherries = _cherries;
+    s.powerpoints = _powerpoints;
+}
+
+void PuckMaze::releaseTexture(void) {
+    delete _maze;
+    _maze = 0;
 }
 
 static inline void SetPixel(SDL_Surface* img, int x, int y, int c) {
@@ -79,48 +109,54 @@ static inline void SetPixel(SDL_Surface* img, int x, int y, int c) {
     data[y * img->pitch + x * 4 + 3] = 255;
 }
 
-void PuckMaze::Redraw(SDL_Surface* img, int X, int Y, int W, int H) {
+void PuckMaze::Redraw(SDL_Surface* img, const MazeSnapshot& maze, int X, int Y, int W, int H) {
     int BGCOLOR = 0;
     int WALLCOLOR = 255;
 
+    const int mazeWidth = maze.width;
+    const int mazeHeight = maze.height;
+    const int cellSize = maze.cellSize;
+    const MazeCell* cells = &maze.cells[0];
+    std::vector<char> cellBuf(cellSize * cellSize);
+
     int pos = 0;
     int x, y;
 
-    if ((Y + H) > height) {
-        H = height - Y;
+    if ((Y + H) > mazeHeight) {
+        H = mazeHeight - Y;
     }
-    if ((X + W) > width) {
-        W = width - X;
+    if ((X + W) > mazeWidth) {
+        W = mazeWidth - X;
     }
 
-    int maxPos = width * height;
+    int maxPos = mazeWidth * mazeHeight;
 
     for (y = Y; y < (Y + H); y++) {
-        pos = y * width + X;
+        pos = y * mazeWidth + X;
         for (x = X; x < (X + W); x++) {
-            int cellPixelCount = _cellSize * _cellSize;
-            char* c = _cellBuf;
+            int cellPixelCount = cellSize * cellSize;
+            char* c = &cellBuf[0];
             for (int i = 0; i < cellPixelCount; i++) {
                 c[i] = BGCOLOR;
             }
 
-            if (map[pos] & WallDN) {
-                for (int i = 1; i <= _cellSize; i++) {
+            if (cells[pos] & WallDN) {
+                for (int i = 1; i <= cellSize; i++) {
                     c[cellPixelCount - i] = WALLCOLOR;
                 }
             }
-            if (map[pos] & WallRT) {
-                for (int i = 0; i < _cellSize; i++) {
-                    c[_cellSize - 1 + i * _cellSize] = WALLCOLOR;
+            if (cells[pos] & WallRT) {
+                for (int i = 0; i < cellSize; i++) {
+                    c[cellSize - 1 + i * cellSize] = WALLCOLOR;
                 }
             }
-            if ((map[pos + 1] & WallDN) || ((pos + width) < maxPos) && (map[pos + width] & WallRT)) {
+            if ((cells[pos + 1] & WallDN) || ((pos + mazeWidth) < maxPos) && (cells[pos + mazeWidth] & WallRT)) {
                 c[cellPixelCount - 1] = WALLCOLOR;
             }
 
-            for (int yy = 0; yy < _cellSize; yy++) {
-                for (int xx = 0; xx < _cellSize; xx++) {
-                    SetPixel(img, x * _cellSize + xx + 1, y * _cellSize + yy + 1, c[yy * _cellSize + xx]);
+            for (int yy = 0; yy < cellSize; yy++) {
+                for (int xx = 0; xx < cellSize; xx++) {
+                    SetPixel(img, x * cellSize + xx + 1, y * cellSize + yy + 1, c[yy * cellSize + xx]);
                 }
             }
 
@@ -128,21 +164,21 @@ void PuckMaze::Redraw(SDL_Surface* img, int X, int Y, int W, int H) {
         }
     }
 
-    pos = Y * width;
+    pos = Y * mazeWidth;
     for (y = Y; y < (Y + H); y++) {
-        if (map[pos] & WallLT) {
-            for (int i = 0; i < _cellSize; i++) {
-                SetPixel(img, 0, y * _cellSize + i, WALLCOLOR);
+        if (cells[pos] & WallLT) {
+            for (int i = 0; i < cellSize; i++) {
+                SetPixel(img, 0, y * cellSize + i, WALLCOLOR);
             }
         }
-        pos += width;
+        pos += mazeWidth;
     }
 
     pos = X;
     for (x = X; x < (X + W); x++) {
-        if (map[pos] & WallUP) {
-            for (int i = 0; i < _cellSize; i++) {
-                SetPixel(img, x * _cellSize + i, 0, WALLCOLOR);
+        if (cells[pos] & WallUP) {
+            for (int i = 0; i < cellSize; i++) {
+                SetPixel(img, x * cellSize + i, 0, WALLCOLOR);
             }
         }
         pos++;
@@ -150,9 +186,10 @@ void PuckMaze::Redraw(SDL_Surface* img, int X, int Y, int W, int H) {
 }
 
 //draw the maze...
-void PuckMaze::UpdateTexture(void) {
+void PuckMaze::UpdateTexture(const MazeSnapshot& maze) {
     delete _maze;
     _maze = 0;
+    _textureSerial = maze.wallsSerial;
 
 #ifdef IPHONE
     string extensions = (char*)glGetString(GL_EXTENSIONS);
@@ -161,18 +198,21 @@ void PuckMaze::UpdateTexture(void) {
 
     SDL_Surface* img = SDL_CreateRGBSurface(SDL_SWSURFACE, 512, 512, 8 * 4, 0, 0, 0, 1);
 
-    Redraw(img, 0, 0, width, height);
+    Redraw(img, maze, 0, 0, maze.width, maze.height);
 
     _maze = new GLTexture(GL_TEXTURE_2D, img, false);
 }
 
-void PuckMaze::draw(const float& x, const float& y, const float& z, const float& scalex, const float& scaley) {
-    float bw = width * _cellSize + 1;
-    float bh = height * _cellSize + 1;
+void PuckMaze::draw(const MazeSnapshot& maze, const float& x, const float& y, const float& z, const float& scalex,
+                    const float& scaley) {
+    if (!_maze || (_textureSerial != maze.wallsSerial)) {
+        UpdateTexture(maze);
+    }
+
+    float bw = maze.width * maze.cellSize + 1;
+    float bh = maze.height * maze.cellSize + 1;
     float textureSize = 512;
 
-    //glEnable(GL_TEXTURE_2D);
-    _maze->bind();
 #ifdef IPHONE
     if (false)  //_hasTexRectExt)
     {
@@ -238,6 +278,7 @@ void PuckMaze::draw(const float& x, const float& y, const float& z, const float&
 
         GLVBO vbo;
         vbo.setColor(0.8f, 0.6f, 0.1f, 0.5f);
+        vbo.setTexture(_maze);
         vbo.DrawTexQuad(v, t);
 #endif
     }
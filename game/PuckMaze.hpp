@@ -19,6 +19,8 @@
 
 #include "SDL.h"
 
+struct MazeSnapshot;
+
 //the pacmaze class add the screen handling, and adds some new elements
 //(in addition to the walls).
 class PuckMaze : public Maze {
@@ -27,13 +29,15 @@ class PuckMaze : public Maze {
 private:
     int _points;
     GLTexture* _maze;
+    int _textureSerial;  //walls the texture shows
+    int _wallsSerial;
     bool _hasTexRectExt;
     int _cellSize;
-    char* _cellBuf;
 
     void AddPoints(void);
 
-    void Redraw(SDL_Surface* img, int X, int Y, int W, int H);
+    void Redraw(SDL_Surface* img, const MazeSnapshot& maze, int X, int Y, int W, int H);
+    void UpdateTexture(const MazeSnapshot& maze);
 
 public:
     PuckMaze();
@@ -41,7 +45,17 @@ public:
 
     void init(int width, int height, int cellSize);
     void reset(void);
-    void draw(const float& x, const float& y, const float& z, const float& scalex, const float& scaley);
+
+    //copy what the view needs, see RenderSnapshot
+    void snapshot(MazeSnapshot& s) const;
+
+    //Draw the walls of a snapshot. The texture is only touched here, so the
+    //maze itself may change on another thread.
+    void draw(const MazeSnapshot& maze, const float& x, const float& y, const float& z, const float& scalex,
+              const float& scaley);
+
+    //drop the texture, e.g. with the GL context, the next draw rebuilds it
+    void releaseTexture(void);
 
     void AddPowerpoints(int numPoints);
 
@@ -50,7 +64,8 @@ public:
         _points--;
     }
 
-    void UpdateTexture(void);
+    //check the running point count against the cherry plane (a popcount)
+    bool verifyPoints(void);
 
     int CellSize(void) { return _cellSize; }
 
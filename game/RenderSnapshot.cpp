@@ -0,0 +1,78 @@
+// Description:
+//   Copy of the game state the in-game view draws from.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include "SDL_mutex.h"
+
+#include <Trace.hpp>
+
+#include <RenderSnapshot.hpp>
+
+#include <algorithm>
+using namespace std;
+
+static void clearSnapshot(RenderSnapshot& s) {
+    s.startOfGameStep = 0;
+
+    s.maze.width = 0;
+    s.maze.height = 0;
+    s.maze.cellSize = 1;
+    s.maze.points = 0;
+    s.maze.wallsSerial = -1;
+
+    s.hero.alive = false;
+    s.hero.visible = false;
+    s.hero.invincible = false;
+    s.hero.frenzy = false;
+    s.hero.energy = 0;
+    s.hero.age = 0;
+
+    s.currentScore = 0;
+    s.highScore = 0;
+    s.currentIsTopTen = false;
+}
+
+SnapshotBuffer::SnapshotBuffer(void) :
+    _back(&_snapshots[0]),
+    _ready(&_snapshots[1]),
+    _front(&_snapshots[2]),
+    _fresh(false),
+    _mutex(SDL_CreateMutex()) {
+    XTRACE();
+    for (int i = 0; i < 3; i++) {
+        clearSnapshot(_snapshots[i]);
+    }
+}
+
+SnapshotBuffer::~SnapshotBuffer() {
+    XTRACE();
+    SDL_DestroyMutex(_mutex);
+}
+
+void SnapshotBuffer::publish(void) {
+    SDL_LockMutex(_mutex);
+    swap(_back, _ready);
+    _fresh = true;
+    SDL_UnlockMutex(_mutex);
+}
+
+RenderSnapshot& SnapshotBuffer::acquire(void) {
+    SDL_LockMutex(_mutex);
+    if (_fresh) {
+        swap(_front, _ready);
+        _fresh = false;
+    }
+    SDL_UnlockMutex(_mutex);
+
+    return *_front;
+}
@@ -0,0 +1,106 @@
+#pragma once
+// Description:
+//   Copy of the game state the in-game view draws from.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <vector>
+
+#include <Singleton.hpp>
+#include <Maze.hpp>
+#include <ParticleInfo.hpp>
+
+struct SDL_mutex;
+
+struct MazeSnapshot {
+    int width;
+    int height;
+    int cellSize;
+    int points;
+    int wallsSerial;  //changes whenever the walls do, see PuckMaze::draw
+
+    std::vector<MazeCell> cells;
+    BitPlane cherries;
+    BitPlane powerpoints;
+
+    //same as the Maze queries
+    Uint32 cell(int x, int y) const { return cells[y * width + x]; }
+
+    const MazeCell* row(int y) const { return &cells[y * width]; }
+
+    int findItem(Uint32 element, int from) const {
+        return (element == CHERRY) ? cherries.findNext(from) : (element == POWERPOINT) ? powerpoints.findNext(from) : -1;
+    }
+};
+
+struct HeroSnapshot {
+    bool alive;
+    bool visible;  //alive, not dying and placed
+    bool invincible;
+    bool frenzy;
+    int energy;
+    int age;
+    ParticleInfo info;
+};
+
+struct RenderSnapshot {
+    //start of the last step taken, for the interpolation fraction
+    double startOfGameStep;
+
+    MazeSnapshot maze;
+    HeroSnapshot hero;
+
+    //live particles of all groups in draw order, with 'next' cleared and
+    //'payload' pointing into payloads
+    std::vector<ParticleInfo> particles;
+    std::vector<ParticlePayload> payloads;
+
+    int currentScore;
+    int highScore;
+    bool currentIsTopTen;
+};
+
+//Double-buffered snapshots between the game steps and the view. The steps
+//fill the back snapshot and publish it, the view acquires the latest one
+//once per frame and draws from it. A third, ready, slot hands a published
+//snapshot over, so neither side ever waits for the other to finish.
+class SnapshotBuffer {
+    friend class Singleton<SnapshotBuffer>;
+
+public:
+    //for the steps: fill, then publish
+    RenderSnapshot& back(void) { return *_back; }
+    void publish(void);
+
+    //for the view: switch to the latest published snapshot, it is the
+    //view's own until the next acquire()
+    RenderSnapshot& acquire(void);
+
+    //the snapshot acquired last
+    RenderSnapshot& current(void) { return *_front; }
+
+private:
+    ~SnapshotBuffer();
+    SnapshotBuffer(void);
+    SnapshotBuffer(const SnapshotBuffer&);
+    SnapshotBuffer& operator=(const SnapshotBuffer&);
+
+    RenderSnapshot _snapshots[3];
+    RenderSnapshot* _back;
+    RenderSnapshot* _ready;
+    RenderSnapshot* _front;
+    bool _fresh;  //_ready is newer than _front
+    SDL_mutex* _mutex;
+};
+
+typedef Singleton<SnapshotBuffer> SnapshotBufferS;
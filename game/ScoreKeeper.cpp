@@ -10,6 +10,7 @@
 #include "Value.hpp"
 #include "Tokenizer.hpp"
 #include "zStream.hpp"
+#include "SaveQueue.hpp"
 #include <RandomKnuth.hpp>
 #include "GetDataPath.hpp"
 
@@ -43,6 +44,97 @@ using namespace std;
 
 const int LEADERBOARD_SIZE = 11;  //top-10 plus current score
 
+//Binary leaderboard file: header (magic, version, payload size, checksum)
+//followed by the payload. All values little endian.
+const char* SCORE_FILE = "leaderboard";
+const char SCORE_MAGIC[4] = {'O', 'C', 'L', 'B'};
+const unsigned int SCORE_VERSION = 5;  //1-4 were text files
+const unsigned int SCORE_HEADER_SIZE = 16;
+const unsigned int MAX_NAME_LENGTH = 1024;
+
+namespace {
+//FNV-1a
+unsigned int checksum(const char* data, size_t size) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void putU32(string& out, unsigned int v) {
+    for (int i = 0; i < 4; i++) {
+        out += (char)((v >> (i * 8)) & 0xff);
+    }
+}
+
+void putU64(string& out, unsigned long long v) {
+    for (int i = 0; i < 8; i++) {
+        out += (char)((v >> (i * 8)) & 0xff);
+    }
+}
+
+void putString(string& out, const string& str) {
+    putU32(out, (unsigned int)str.length());
+    out += str;
+}
+
+//Bounds checked reads, any failure sticks so callers can check once at the end.
+class ScoreReader {
+public:
+    ScoreReader(const string& data, size_t pos) :
+        _data(data),
+        _pos(pos),
+        _ok(true) {}
+
+    bool ok(void) const { return _ok; }
+
+    unsigned int u32(void) {
+        unsigned int v = 0;
+        if (need(4)) {
+            for (int i = 0; i < 4; i++) {
+                v |= (unsigned int)(unsigned char)_data[_pos++] << (i * 8);
+            }
+        }
+        return v;
+    }
+
+    unsigned long long u64(void) {
+        unsigned long long v = 0;
+        if (need(8)) {
+            for (int i = 0; i < 8; i++) {
+                v |= (unsigned long long)(unsigned char)_data[_pos++] << (i * 8);
+            }
+        }
+        return v;
+    }
+
+    string str(void) {
+        unsigned int len = u32();
+        if ((len > MAX_NAME_LENGTH) || !need(len)) {
+            _ok = false;
+            return "";
+        }
+        string s = _data.substr(_pos, len);
+        _pos += len;
+        return s;
+    }
+
+private:
+    bool need(size_t n) {
+        if (!_ok || (_data.size() - _pos < n)) {
+            _ok = false;
+        }
+        return _ok;
+    }
+
+    const string& _data;
+    size_t _pos;
+    bool _ok;
+};
+}
+
 static RandomKnuth _random;
 
 ScoreKeeper::ScoreKeeper(void) :
@@ -64,7 +156,7 @@ void ScoreKeeper::resetCurrentScore(void) {
     _currentIndex = LEADERBOARD_SIZE - 1;
     _leaderBoard[_currentIndex].score = 0;
     _leaderBoard[_currentIndex].name = "Anonymous";
-    _leaderBoard[_currentIndex].time = 0;
+    time(&_leaderBoard[_currentIndex].time);  //played on
     _leaderBoard[_currentIndex].points = 0;
     _leaderBoard[_currentIndex].msPlayed = 0;
 }
@@ -94,7 +186,6 @@ int ScoreKeeper::addToCurrentScore(int score) {
         pi.position.z = 0;
         char buf[10];
         sprintf( buf, "%d", newValue);
-        pi.text = buf;
 
         if( cubes)
         {
@@ -109,7 +200,7 @@ int ScoreKeeper::addToCurrentScore(int score) {
             pi.color.z = 0.0f;
         }
 
-        effects->newParticle( "ScoreHighlight", pi);
+        effects->newParticle( "ScoreHighlight", pi, buf);
     }
 #endif
 
@@ -120,9 +211,11 @@ int ScoreKeeper::addToCurrentScore(int score) {
             _leaderBoard[_currentIndex].points++;
         }
         _leaderBoard[_currentIndex].msPlayed = HeroS::instance()->Age();
-        time(&_leaderBoard[_currentIndex].time);
 
-        sortLeaderBoard();
+        //only re-rank once we pass the next entry up
+        if ((_currentIndex > 0) && (_leaderBoard[_currentIndex].score > _leaderBoard[_currentIndex - 1].score)) {
+            sortLeaderBoard();
+        }
     }
 #endif
     //return the real value;
@@ -150,11 +243,11 @@ void ScoreKeeper::setLeaderBoard(const std::string& scoreboardName) {
     }
 
     if (i != _scoreBoards.end()) {
-        stringToLeaderBoard(i->data, _leaderBoard);
+        _leaderBoard = i->entries;
+        _leaderBoard.resize(LEADERBOARD_SIZE);
     } else {
         resetLeaderBoard(_leaderBoard);
-        string data = leaderBoardToString(_leaderBoard, scoreboardName);
-        addScoreBoard(scoreboardName, data);
+        addScoreBoard(scoreboardName, _leaderBoard);
     }
 
     _leaderBoardName = scoreboardName;
@@ -209,23 +302,6 @@ void ScoreKeeper::sortLeaderBoard(void) {
     //dumpLeaderBoard( _leaderBoard);
 }
 
-string ScoreKeeper::leaderBoardToString(LeaderBoard& lb, const string& leaderBoardName) {
-    ostringstream ostr;
-    ostr << leaderBoardName << "\001";
-
-    for (unsigned int i = 0; i < lb.size(); i++) {
-        if (lb[i].name == "") {
-            lb[i].name = "Anonymous";
-        }
-        ostr << lb[i].name << "\002" << lb[i].score << "\002" << (long)lb[i].time << "\002" << lb[i].points << "\002"
-             << lb[i].msPlayed << "\002";
-    }
-
-    LOG_INFO << "leaderBoardToString [" << ostr.str() << "]\n";
-
-    return ostr.str();
-}
-
 void ScoreKeeper::stringToLeaderBoard(const string& lbString, LeaderBoard& lb) {
     Tokenizer t(lbString, false, "\001\002");
 
@@ -262,8 +338,6 @@ void ScoreKeeper::stringToLeaderBoard(const string& lbString, LeaderBoard& lb) {
 
     //should already be sorted, but better be safe...
     sort(lb.begin(), lb.end());
-
-    dumpLeaderBoard(lb);
 }
 
 void ScoreKeeper::dumpLeaderBoard(const LeaderBoard& lb) {
@@ -317,16 +391,16 @@ void ScoreKeeper::updateScoreBoardWithLeaderBoard(void) {
     ScoreBoards::iterator i;
     for (i = _scoreBoards.begin(); i < _scoreBoards.end(); i++) {
         if (i->name == _leaderBoardName) {
-            i->data = leaderBoardToString(_leaderBoard, _leaderBoardName);
+            i->entries = _leaderBoard;
             break;
         }
     }
 }
 
-void ScoreKeeper::addScoreBoard(const string& scoreboardName, const string& data) {
+void ScoreKeeper::addScoreBoard(const string& scoreboardName, const LeaderBoard& entries) {
     ScoreBoard newBoard;
     newBoard.name = scoreboardName;
-    newBoard.data = data;
+    newBoard.entries = entries;
     _scoreBoards.push_back(newBoard);
 
     sort(_scoreBoards.begin(), _scoreBoards.end());
@@ -356,12 +430,12 @@ void ScoreKeeper::setActive(string scoreboardName) {
     }
 
     if (_currentScoreboard != _scoreBoards.end()) {
-        stringToLeaderBoard(_currentScoreboard->data, _currentScoreboardAsLeaderBoard);
+        _currentScoreboardAsLeaderBoard = _currentScoreboard->entries;
     } else {
         LOG_WARNING << "Board [" << scoreboardName << "] does not exist! Creating...\n";
+        _currentScoreboardAsLeaderBoard.resize(LEADERBOARD_SIZE);
         resetLeaderBoard(_currentScoreboardAsLeaderBoard);
-        string data = leaderBoardToString(_currentScoreboardAsLeaderBoard, scoreboardName);
-        addScoreBoard(scoreboardName, data);
+        addScoreBoard(scoreboardName, _currentScoreboardAsLeaderBoard);
     }
 }
 
@@ -373,7 +447,7 @@ void ScoreKeeper::nextBoard(void) {
         _currentScoreboard = _scoreBoards.begin();
     }
     if (_currentScoreboard != _scoreBoards.end()) {
-        stringToLeaderBoard(_currentScoreboard->data, _currentScoreboardAsLeaderBoard);
+        _currentScoreboardAsLeaderBoard = _currentScoreboard->entries;
     }
 }
 
@@ -385,71 +459,146 @@ void ScoreKeeper::prevBoard(void) {
     }
     _currentScoreboard--;
     if (_currentScoreboard != _scoreBoards.end()) {
-        stringToLeaderBoard(_currentScoreboard->data, _currentScoreboardAsLeaderBoard);
+        _currentScoreboardAsLeaderBoard = _currentScoreboard->entries;
     }
 }
 
 void ScoreKeeper::load(void) {
 #ifndef DEMO
     XTRACE();
-    string scoreFilename = "leaderboard";
-    LOG_INFO << "Loading hi-scores from " << scoreFilename << endl;
+    LOG_INFO << "Loading hi-scores from " << SCORE_FILE << endl;
 
-    int version = 1;
-    ziStream infile(scoreFilename.c_str());
-    if (infile.isOK())  //infile.good())
-    {
-        string line;
-        while (!getline(infile, line).eof()) {
-            LOG_INFO << "[" << line << "]" << endl;
-            //explicitly skip comments
-            if (line[0] == '#') {
-                continue;
-            }
+    ziStream infile(SCORE_FILE);
+    if (!infile.isOK()) {
+        return;
+    }
+
+    string data = infile.readAll();
+    bool binary = (data.size() >= sizeof(SCORE_MAGIC)) &&
+                  (data.compare(0, sizeof(SCORE_MAGIC), SCORE_MAGIC, sizeof(SCORE_MAGIC)) == 0);
+    if (binary) {
+        if (!loadBinary(data)) {
+            _scoreBoards.clear();
+            _currentScoreboard = _scoreBoards.end();
+        }
+    } else {
+        loadLegacy(data);
+    }
+    LOG_INFO << "Loaded " << _scoreBoards.size() << " score boards" << endl;
+#endif
+}
 
-            Tokenizer tv(line, false, " \t\n\r");
-            string token = tv.next();
-            if (token == "Version") {
-                string versionString = tv.next();
-                version = atoi(versionString.c_str());
+bool ScoreKeeper::loadBinary(const string& data) {
+    ScoreReader header(data, sizeof(SCORE_MAGIC));
+    unsigned int version = header.u32();
+    unsigned int size = header.u32();
+    unsigned int sum = header.u32();
 
-                if (version != 4) {
-                    LOG_ERROR << "Wrong version in score file!" << endl;
-                    return;
-                }
-            } else {
-                Tokenizer t(line, false, "\001\002");
-                string scoreboardName = t.next();
+    if (!header.ok() || (version != SCORE_VERSION)) {
+        LOG_ERROR << "Wrong version in score file!" << endl;
+        return false;
+    }
+    if ((data.size() - SCORE_HEADER_SIZE != size) || (checksum(data.data() + SCORE_HEADER_SIZE, size) != sum)) {
+        LOG_ERROR << "Score file is corrupt, ignoring it." << endl;
+        return false;
+    }
 
-                if (scoreboardName != "") {
-                    addScoreBoard(scoreboardName, line);
-                }
+    ScoreReader in(data, SCORE_HEADER_SIZE);
+    unsigned int numBoards = in.u32();
+    for (unsigned int b = 0; (b < numBoards) && in.ok(); b++) {
+        string scoreboardName = in.str();
+        unsigned int numEntries = in.u32();
+        if (numEntries > (unsigned int)LEADERBOARD_SIZE) {
+            LOG_ERROR << "Score file is corrupt, ignoring it." << endl;
+            return false;
+        }
+
+        LeaderBoard lb(numEntries);
+        for (unsigned int i = 0; i < numEntries; i++) {
+            lb[i].score = (int)in.u32();
+            lb[i].time = (time_t)in.u64();
+            lb[i].points = (int)in.u32();
+            lb[i].msPlayed = (int)in.u32();
+            lb[i].name = in.str();
+        }
+
+        if (in.ok() && (scoreboardName != "")) {
+            //should already be sorted, but better be safe...
+            sort(lb.begin(), lb.end());
+            addScoreBoard(scoreboardName, lb);
+        }
+    }
+
+    if (!in.ok()) {
+        LOG_ERROR << "Score file is truncated, ignoring it." << endl;
+        return false;
+    }
+    return true;
+}
+
+void ScoreKeeper::loadLegacy(const string& data) {
+    istringstream infile(data);
+    string line;
+    while (!getline(infile, line).eof()) {
+        //explicitly skip comments
+        if (line[0] == '#') {
+            continue;
+        }
+
+        Tokenizer tv(line, false, " \t\n\r");
+        string token = tv.next();
+        if (token == "Version") {
+            string versionString = tv.next();
+            int version = atoi(versionString.c_str());
+
+            if (version != 4) {
+                LOG_ERROR << "Wrong version in score file!" << endl;
+                return;
+            }
+        } else {
+            Tokenizer t(line, false, "\001\002");
+            string scoreboardName = t.next();
+
+            if (scoreboardName != "") {
+                LeaderBoard lb;
+                stringToLeaderBoard(line, lb);
+                addScoreBoard(scoreboardName, lb);
             }
         }
     }
-#endif
 }
 
 void ScoreKeeper::save(void) {
 #ifndef DEMO
     XTRACE();
-    string scoreFilename = "leaderboard";
-    LOG_INFO << "Saving hi-scores to " << scoreFilename << endl;
+    LOG_INFO << "Saving hi-scores to " << SCORE_FILE << endl;
 
-    //Save scores in a compressed file to make it a bit tougher to cheat...
-    zoStream outfile(scoreFilename.c_str());
-    if (outfile.good()) {
-        outfile << "#------LeaderBoard-----#" << endl;
-        outfile << "Version 4" << endl;
-
-        updateScoreBoardWithLeaderBoard();
+    updateScoreBoardWithLeaderBoard();
 
-        ScoreBoards::const_iterator ci;
-        for (ci = _scoreBoards.begin(); ci != _scoreBoards.end(); ci++) {
-            LOG_INFO << "[" << ci->data << "]" << endl;
-            outfile << ci->data << endl;
+    string payload;
+    putU32(payload, (unsigned int)_scoreBoards.size());
+    ScoreBoards::const_iterator ci;
+    for (ci = _scoreBoards.begin(); ci != _scoreBoards.end(); ci++) {
+        putString(payload, ci->name);
+        putU32(payload, (unsigned int)ci->entries.size());
+        for (size_t i = 0; i < ci->entries.size(); i++) {
+            const ScoreData& sd = ci->entries[i];
+            putU32(payload, (unsigned int)sd.score);
+            putU64(payload, (unsigned long long)sd.time);
+            putU32(payload, (unsigned int)sd.points);
+            putU32(payload, (unsigned int)sd.msPlayed);
+            putString(payload, (sd.name == "") ? string("Anonymous") : sd.name);
         }
     }
+
+    string file(SCORE_MAGIC, sizeof(SCORE_MAGIC));
+    putU32(file, SCORE_VERSION);
+    putU32(file, (unsigned int)payload.size());
+    putU32(file, checksum(payload.data(), payload.size()));
+    file += payload;
+
+    //written to a temp file and renamed over the old one in the background
+    SaveQueueS::instance()->save(SCORE_FILE, file);
 #endif
 }
 
@@ -468,7 +617,6 @@ void ScoreKeeper::draw(const Point2Di& offset) {
 
     if (numBoards() > 1) {
         //glEnable(GL_TEXTURE_2D);
-        icons->bind();
         int slider = icons->getIndex("Slider");
         icons->setColor(1.0, 1.0, 1.0, 1.0);
         icons->Draw(slider, vec2i(50, 505), vec2i(150, 605));
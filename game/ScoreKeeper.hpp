@@ -32,9 +32,11 @@ inline bool operator<(const ScoreData& s1, const ScoreData& s2) {
     return s1.score > s2.score;
 }
 
+typedef std::vector<ScoreData> LeaderBoard;
+
 struct ScoreBoard {
     std::string name;
-    std::string data;  // top-10 as string data
+    LeaderBoard entries;  //sorted, highscore first
 };
 
 inline bool operator<(const ScoreBoard& s1, const ScoreBoard& s2) {
@@ -88,7 +90,6 @@ public:
     void setPracticeMode(bool practiceMode) { _practiceMode = practiceMode; }
 
 private:
-    typedef std::vector<ScoreData> LeaderBoard;
     typedef std::vector<ScoreBoard> ScoreBoards;
 
     ScoreKeeper(const ScoreKeeper&);
@@ -96,11 +97,13 @@ private:
 
     void resetLeaderBoard(LeaderBoard& lb);
     void sortLeaderBoard(void);
-    string leaderBoardToString(LeaderBoard& lb, const string& leaderBoardName);
-    void stringToLeaderBoard(const std::string& lbString, LeaderBoard& lb);
     void dumpLeaderBoard(const LeaderBoard& lb);
 
-    void addScoreBoard(const string& scoreboardName, const string& data);
+    bool loadBinary(const std::string& data);
+    void loadLegacy(const std::string& data);
+    void stringToLeaderBoard(const std::string& lbString, LeaderBoard& lb);
+
+    void addScoreBoard(const string& scoreboardName, const LeaderBoard& entries);
 
     unsigned int _currentIndex;
     unsigned int _infoIndex;
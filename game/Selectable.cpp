@@ -165,7 +165,6 @@ void EscapeSelectable::activate(bool beQuiet) {
 void EscapeSelectable::draw(const Point2Di& offset) {
     Selectable::draw(offset);
 
-    _icons->bind();
     //glColor4f(1.0, 1.0, 1.0, 1.0);
     //glEnable(GL_TEXTURE_2D);
     _icons->setColor(1.0, 1.0, 1.0, 1.0);
@@ -343,7 +342,6 @@ void ImageOnlySelectable::draw(const Point2Di& offset) {
     //glColor4f(1.0, 1.0, 1.0, 1.0);
 
     //glEnable(GL_TEXTURE_2D);
-    _icons->bind();
     _icons->setColor(1.0, 1.0, 1.0, 1.0);
     _icons->DrawC(_image, _boundingBox.min.x + offset.x, _boundingBox.min.y + offset.y, _size, _size);
     //glDisable(GL_TEXTURE_2D);
@@ -476,7 +474,6 @@ void FloatSelectable::activate(bool beQuiet) {
 void FloatSelectable::draw(const Point2Di& offset) {
     TextOnlySelectable::draw(offset);
 
-    _icons->bind();
     vec4f color;
     if (_active == this) {
         if (!_enabled) {
@@ -707,7 +704,6 @@ void BoolSelectable::draw(const Point2Di& offset) {
     bool val = false;
     ConfigS::instance()->getBoolean(_variable, val);
 
-    _icons->bind();
     vec4f color(1.0, 1.0, 1.0, 1.0);
     if (_active == this) {
         if (!_enabled) {
@@ -1110,7 +1106,6 @@ void ResolutionSelectable::draw(const Point2Di& offset) {
     _fontWhite->DrawString(resolution.c_str(), xOff + _boundingBox.min.x + offset.x, _boundingBox.min.y + offset.y,
                            _size, _size);
 
-    _icons->bind();
     vec4f color;
     if (_active == this) {
         if (!_enabled) {
@@ -1304,7 +1299,6 @@ void MenuSelectable::draw(const Point2Di& offset) {
     float cherrySize = 1.0;
     float xOff = _fontWhite->GetWidth(_text.c_str(), cherrySize);
 
-    _icons->bind();
 
     //glColor4f(1.0, 1.0, 1.0, 0.7);
     //glEnable(GL_TEXTURE_2D);
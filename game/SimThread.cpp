@@ -0,0 +1,123 @@
+// Description:
+//   Optional thread running the in-game logic steps.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include "SDL.h"
+
+#include <Trace.hpp>
+#include <Config.hpp>
+
+#include <SimThread.hpp>
+#include <Game.hpp>
+#include <GameState.hpp>
+#include <FrameScheduler.hpp>
+
+using namespace std;
+
+//how long to wait for the game to (re)start before looking again
+const Uint32 IDLE_DELAY_MS = 10;
+
+SimThread::SimThread(void) :
+    _thread(0),
+    _world(0),
+    _quit(false) {
+    XTRACE();
+}
+
+SimThread::~SimThread() {
+    XTRACE();
+    stop();
+}
+
+void SimThread::init(void) {
+    stop();
+
+    bool enabled = false;
+    ConfigS::instance()->getBoolean("simThread", enabled);
+
+#if defined(EMSCRIPTEN)
+    //no pthreads in the web build
+    enabled = false;
+#endif
+
+    if (enabled) {
+        _world = SDL_CreateMutex();
+        _quit = false;
+        _thread = SDL_CreateThread(run, "Simulation", this);
+        if (!_thread) {
+            LOG_WARNING << "Unable to start simulation thread: " << SDL_GetError() << endl;
+            SDL_DestroyMutex(_world);
+            _world = 0;
+        }
+    }
+
+    LOG_INFO << "Simulation thread: " << (_thread ? "on" : "off") << endl;
+}
+
+void SimThread::stop(void) {
+    if (_thread) {
+        SDL_LockMutex(_world);
+        _quit = true;
+        SDL_UnlockMutex(_world);
+
+        SDL_WaitThread(_thread, 0);
+        _thread = 0;
+    }
+
+    if (_world) {
+        SDL_DestroyMutex(_world);
+        _world = 0;
+    }
+}
+
+void SimThread::lockWorld(void) {
+    if (_thread) {
+        SDL_LockMutex(_world);
+    }
+}
+
+void SimThread::unlockWorld(void) {
+    if (_thread) {
+        SDL_UnlockMutex(_world);
+    }
+}
+
+int SimThread::run(void* data) {
+    static_cast<SimThread*>(data)->work();
+    return 0;
+}
+
+void SimThread::work(void) {
+    FrameScheduler& scheduler = *FrameSchedulerS::instance();
+
+    for (;;) {
+        Uint32 delay = IDLE_DELAY_MS;
+
+        SDL_LockMutex(_world);
+        if (_quit) {
+            SDL_UnlockMutex(_world);
+            break;
+        }
+
+        if (GameState::context == Context::eInGame) {
+            GameS::instance()->updateInGameLogic();
+
+            //sleep until the next step is due
+            double due = GameState::startOfGameStep + scheduler.getStepSize() - GameState::stopwatch.getTime();
+            delay = (due > 0) ? (Uint32)(due * 1000.0) + 1 : 1;
+        }
+        SDL_UnlockMutex(_world);
+
+        SDL_Delay(delay);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+// Description:
+//   Optional thread running the in-game logic steps.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <Singleton.hpp>
+
+struct SDL_Thread;
+struct SDL_mutex;
+
+//When enabled (simThread config value) the in-game logic steps run on their
+//own thread at the logic rate instead of once per frame in the main loop.
+//After each batch of steps the thread publishes a RenderSnapshot, and the
+//view draws from the latest one, so recording, flushing and swapping a frame
+//never hold up the steps.
+//The world lock is held by the sim thread for a batch of steps. The main
+//thread only takes it to change game state itself: context switches, a new
+//game and the name entry after it.
+class SimThread {
+    friend class Singleton<SimThread>;
+
+public:
+    //reads simThread from config, never enabled in the web build
+    void init(void);
+
+    bool isRunning(void) const { return _thread != 0; }
+
+    //no-ops while the thread isn't running, see WorldLock
+    void lockWorld(void);
+    void unlockWorld(void);
+
+private:
+    ~SimThread();
+    SimThread(void);
+    SimThread(const SimThread&);
+    SimThread& operator=(const SimThread&);
+
+    static int run(void* data);
+    void work(void);
+    void stop(void);
+
+    SDL_Thread* _thread;
+    SDL_mutex* _world;
+    bool _quit;  //guarded by the world lock
+};
+
+typedef Singleton<SimThread> SimThreadS;
+
+//holds the world lock for its scope
+class WorldLock {
+public:
+    WorldLock(void) { SimThreadS::instance()->lockWorld(); }
+    ~WorldLock() { SimThreadS::instance()->unlockWorld(); }
+
+private:
+    WorldLock(const WorldLock&);
+    WorldLock& operator=(const WorldLock&);
+};
@@ -71,7 +71,8 @@ void Tracer::Add(int x, int y, int dir, int dist) {
 //do a recursive search. Slow but cute :)
 int Tracer::Find(int x, int y, Uint32 element, int len) {
 #define MAXLEN 6
-    if (maze->isElement(x, y, element)) {
+    Uint32 cell = maze->cell(x, y);
+    if (cell & element) {
         return len;
     }
 
@@ -83,26 +84,26 @@ int Tracer::Find(int x, int y, Uint32 element, int len) {
     int dir = 0;
     int mlen;
 
-    if (!maze->isElement(x, y, WallUP)) {
+    if (!(cell & WallUP)) {
         min = Find(x, y - 1, element, len + 1);
         dir = WallUP;
     }
 
-    if (!maze->isElement(x, y, WallLT)) {
+    if (!(cell & WallLT)) {
         mlen = Find(x - 1, y, element, len + 1);
         if (mlen < min) {
             min = mlen;
             dir = WallLT;
         }
     }
-    if (!maze->isElement(x, y, WallDN)) {
+    if (!(cell & WallDN)) {
         mlen = Find(x, y + 1, element, len + 1);
         if (mlen < min) {
             min = mlen;
             dir = WallDN;
         }
     }
-    if (!maze->isElement(x, y, WallRT)) {
+    if (!(cell & WallRT)) {
         mlen = Find(x + 1, y, element, len + 1);
         if (mlen < min) {
             min = mlen;
@@ -151,16 +152,17 @@ int NEWTracer::Find2(int x, int y, Uint32 element) {
     memset(map, NOTCHECKED, maze->Width() * maze->Height());
 
     // add possible trace directions
-    if (!maze->isElement(x, y, WallUP)) {
+    Uint32 cell = maze->cell(x, y);
+    if (!(cell & WallUP)) {
         Add(x, y - 1, WallUP, 1);
     }
-    if (!maze->isElement(x, y, WallLT)) {
+    if (!(cell & WallLT)) {
         Add(x - 1, y, WallLT, 1);
     }
-    if (!maze->isElement(x, y, WallDN)) {
+    if (!(cell & WallDN)) {
         Add(x, y + 1, WallDN, 1);
     }
-    if (!maze->isElement(x, y, WallRT)) {
+    if (!(cell & WallRT)) {
         Add(x + 1, y, WallRT, 1);
     }
     //the distance from our starting point (x,y)
@@ -186,7 +188,8 @@ int NEWTracer::Find2(int x, int y, Uint32 element) {
         map[ya * maze->Width() + xa] = CHECKED;
 
         //check if there is an "element" at the current position
-        if (maze->isElement(xa, ya, element)) {
+        cell = maze->cell(xa, ya);
+        if (cell & element) {
             //Note, we could just return "oDir" here
             //but this would resuWallLT in an
             //WallUP-down, left-right (ie. the order
@@ -200,25 +203,25 @@ int NEWTracer::Find2(int x, int y, Uint32 element) {
         }
 
         // add if there is no wall and field not checked
-        if (!maze->isElement(xa, ya, WallUP)) {
+        if (!(cell & WallUP)) {
             if (map[(ya - 1) * maze->Width() + xa] != CHECKED) {
                 Add(xa, ya - 1, oDir, dist);
             }
         }
 
-        if (!maze->isElement(xa, ya, WallLT)) {
+        if (!(cell & WallLT)) {
             if (map[ya * maze->Width() + xa - 1] != CHECKED) {
                 Add(xa - 1, ya, oDir, dist);
             }
         }
 
-        if (!maze->isElement(xa, ya, WallDN)) {
+        if (!(cell & WallDN)) {
             if (map[(ya + 1) * maze->Width() + xa] != CHECKED) {
                 Add(xa, ya + 1, oDir, dist);
             }
         }
 
-        if (!maze->isElement(xa, ya, WallRT)) {
+        if (!(cell & WallRT)) {
             if (map[ya * maze->Width() + xa + 1] != CHECKED) {
                 Add(xa + 1, ya, oDir, dist);
             }
@@ -312,19 +315,20 @@ char* Tracer::FindPath(int x, int y, Uint32 element) {
     ADDLOCATION(ROOT, 0);
 
     // add possible trace directions
-    if (!maze->isElement(x, y, WallUP)) {
+    Uint32 cell = maze->cell(x, y);
+    if (!(cell & WallUP)) {
         Add(x, y - 1, idx, 1);
         ADDLOCATION(WallUP, 0);
     }
-    if (!maze->isElement(x, y, WallDN)) {
+    if (!(cell & WallDN)) {
         Add(x, y + 1, idx, 1);
         ADDLOCATION(WallDN, 0);
     }
-    if (!maze->isElement(x, y, WallLT)) {
+    if (!(cell & WallLT)) {
         Add(x - 1, y, idx, 1);
         ADDLOCATION(WallLT, 0);
     }
-    if (!maze->isElement(x, y, WallRT)) {
+    if (!(cell & WallRT)) {
         Add(x + 1, y, idx, 1);
         ADDLOCATION(WallRT, 0);
     }
@@ -345,7 +349,8 @@ char* Tracer::FindPath(int x, int y, Uint32 element) {
         map[ya * maze->Width() + xa] = CHECKED;
 
         //check if there is an "element" at the current position
-        if (maze->isElement(xa, ya, element)) {
+        cell = maze->cell(xa, ya);
+        if (cell & element) {
             int pIdx = 0;
             while (from[prevn] != ROOT) {
                 path[pIdx++] = from[prevn];
@@ -356,28 +361,28 @@ char* Tracer::FindPath(int x, int y, Uint32 element) {
         }
 
         // add if there is no wall and field not checked
-        if (!maze->isElement(xa, ya, WallUP)) {
+        if (!(cell & WallUP)) {
             if (map[(ya - 1) * maze->Width() + xa] != CHECKED) {
                 Add(xa, ya - 1, idx, dist);
                 ADDLOCATION(WallUP, prevn);
             }
         }
 
-        if (!maze->isElement(xa, ya, WallDN)) {
+        if (!(cell & WallDN)) {
             if (map[(ya + 1) * maze->Width() + xa] != CHECKED) {
                 Add(xa, ya + 1, idx, dist);
                 ADDLOCATION(WallDN, prevn);
             }
         }
 
-        if (!maze->isElement(xa, ya, WallLT)) {
+        if (!(cell & WallLT)) {
             if (map[ya * maze->Width() + xa - 1] != CHECKED) {
                 Add(xa - 1, ya, idx, dist);
                 ADDLOCATION(WallLT, prevn);
             }
         }
 
-        if (!maze->isElement(xa, ya, WallRT)) {
+        if (!(cell & WallRT)) {
             if (map[ya * maze->Width() + xa + 1] != CHECKED) {
                 Add(xa + 1, ya, idx, dist);
                 ADDLOCATION(WallRT, prevn);
@@ -27,6 +27,9 @@ struct Trigger {
     // text input
     std::string text;
 
+    //Timer::getTime() when the event happened
+    double time;
+
     bool operator==(const Trigger& t) const {
         if ((type == eMotionTrigger) && (type == t.type)) {
             return true;
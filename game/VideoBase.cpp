@@ -12,7 +12,7 @@
 #include "Value.hpp"
 #include "Timer.hpp"
 
-#include "PNG.hpp"
+#include "FrameCapture.hpp"
 
 #include "Constants.hpp"
 #include "VideoBase.hpp"
@@ -27,6 +27,9 @@
 #include "TextureManager.hpp"
 
 #include "GLBitmapCollection.hpp"
+#include "RenderQueue.hpp"
+#include "gl3/StateCache.hpp"
+#include "gl3/ErrorCheck.hpp"
 #include "Input.hpp"
 
 using namespace std;
@@ -63,6 +66,9 @@ VideoBase::~VideoBase() {
 
     TextureManagerS::cleanup();
 
+    FrameCaptureS::cleanup();
+    RenderQueueS::cleanup();
+
     CameraS::cleanup();
 
     SDL_QuitSubSystem(SDL_INIT_VIDEO);
@@ -70,6 +76,8 @@ VideoBase::~VideoBase() {
 }
 
 void VideoBase::reload(void) {
+    StateCache::invalidate();
+    RenderQueueS::instance()->reset();
     BitmapManagerS::instance()->reset();
     FontManagerS::instance()->reset();
     ModelManagerS::instance()->reset();
@@ -102,6 +110,7 @@ bool VideoBase::init(void) {
     if (!setVideoMode()) {
         return false;
     }
+    FrameCaptureS::instance()->init();
 #if 0
     GLBitmapCollection *icons =
         BitmapManagerS::instance()->getBitmap( "bitmaps/menuIcons");
@@ -115,23 +124,6 @@ bool VideoBase::init(void) {
     return true;
 }
 
-#ifdef DEBUG_OPENGL
-void GLAPIENTRY
-MessageCallback(GLenum source,
-    GLenum type,
-    GLuint id,
-    GLenum severity,
-    GLsizei length,
-    const GLchar* message,
-    const void* userParam)
-{
-    if (severity == GL_DEBUG_SEVERITY_LOW || severity == GL_DEBUG_SEVERITY_NOTIFICATION) {
-        return;
-    }
-    LOG_INFO << "GL Error: " << message << " - type: " << hex << type << " - severity: " << severity << "\n";
-}
-#endif
-
 bool VideoBase::setVideoMode(void) {
     ConfigS::instance()->getBoolean("fullscreen", _isFullscreen);
     ConfigS::instance()->getInteger("width", _width);
@@ -185,6 +177,7 @@ bool VideoBase::setVideoMode(void) {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 #endif
     if (_glContext) {
+        FrameCaptureS::instance()->reset();
         SDL_GL_DeleteContext(_glContext);
         _glContext = 0;
     }
@@ -208,6 +201,16 @@ bool VideoBase::setVideoMode(void) {
         SDL_QuitSubSystem(SDL_INIT_VIDEO);
         return false;
     }
+    //new context, nothing is known about its state
+    StateCache::invalidate();
+
+    //0: off, 1: on, -1: adaptive (late frames tear instead of waiting another refresh)
+    int vsync = 1;
+    ConfigS::instance()->getInteger("vsync", vsync);
+    if ((SDL_GL_SetSwapInterval(vsync) != 0) && (vsync == -1)) {
+        LOG_WARNING << "Adaptive vsync not supported, using vsync." << endl;
+        SDL_GL_SetSwapInterval(1);
+    }
 
 #if 0
     SDL_ShowWindow(_windowHandle);
@@ -271,11 +274,16 @@ bool VideoBase::setVideoMode(void) {
     LOG_INFO << "  Context : " << major << "." << minor << endl;
     LOG_INFO << "  GLEW : " << glewGetString(GLEW_VERSION) << endl;
 
+    //release builds do no per-frame error queries unless asked to
 #ifdef DEBUG_OPENGL
-    // During init, enable debug output
-    glEnable(GL_DEBUG_OUTPUT);
-    glDebugMessageCallback(MessageCallback, 0);
+    int glErrors = GLErrorMode::eCallback;
+#else
+    int glErrors = GameState::isDeveloper ? GLErrorMode::eSampled : GLErrorMode::eOff;
 #endif
+    int glErrorSampleFrames = 60;
+    ConfigS::instance()->getInteger("glErrors", glErrors);
+    ConfigS::instance()->getInteger("glErrorSampleFrames", glErrorSampleFrames);
+    ErrorCheck::init((GLErrorMode::GLErrorModeEnum)glErrors, glErrorSampleFrames);
 
 #if 0
     GLint range[2];
@@ -403,28 +411,14 @@ void VideoBase::draw(bool oneToOne) {
 }
 
 void VideoBase::takeSnapshot(void) {
-    static int count = 0;
-
-    char filename[128];
-    sprintf(filename, "snap%02d.png", count++);
-    SDL_Surface* img;
-
-    img = SDL_CreateRGBSurface(0, _width, _height, 24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
-
-    if (img) {
-        glReadPixels(0, 0, _width, _height, GL_RGB, GL_UNSIGNED_BYTE, img->pixels);
-
-        LOG_INFO << "Writing snapshot: " << filename << endl;
-        if (!PNG::Snapshot(img, filename)) {
-            LOG_ERROR << "Failed to save snapshot." << endl;
-        }
-        SDL_FreeSurface(img);
-    } else {
-        LOG_ERROR << "Failed to create surface for snapshot." << endl;
-        LOG_ERROR << "SDL: " << SDL_GetError() << "\n";
-    }
+    //read back at the end of this frame
+    FrameCaptureS::instance()->requestSnapshot();
 }
 
 void VideoBase::swap(void) {
+    RenderQueueS::instance()->endFrame();
+    FrameCaptureS::instance()->endFrame(_width, _height);
+    StateCache::endFrame();
+    ErrorCheck::endFrame();
     SDL_GL_SwapWindow(_windowHandle);
 }
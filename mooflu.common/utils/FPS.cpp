@@ -20,7 +20,7 @@
 WPP::WPP(double period) :
     _cpp(0.0),
     _period(period),
-    _oldTime(0.0),
+    _oldTime(Timer::getTime()),
     _count(0) {}
 
 void WPP::Update(void) {
@@ -0,0 +1,90 @@
+// Description:
+//   Fixed size histogram with percentile queries.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include "Histogram.hpp"
+
+#include <string.h>
+
+Histogram::Histogram(double bucketWidth, int numBuckets) :
+    _bucketWidth(bucketWidth),
+    _numBuckets(numBuckets),
+    _buckets(new std::atomic<unsigned int>[numBuckets]),
+    _count(0),
+    _maxBits(0) {
+    reset();
+}
+
+Histogram::~Histogram() {
+    delete[] _buckets;
+}
+
+void Histogram::reset(void) {
+    for (int i = 0; i < _numBuckets; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _maxBits.store(0, std::memory_order_relaxed);
+}
+
+void Histogram::add(double value) {
+    if (value < 0) {
+        value = 0;
+    }
+
+    int bucket = (int)(value / _bucketWidth);
+    if (bucket >= _numBuckets) {
+        bucket = _numBuckets - 1;
+    }
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    unsigned long long prev = _maxBits.load(std::memory_order_relaxed);
+    while ((bits > prev) && !_maxBits.compare_exchange_weak(prev, bits, std::memory_order_relaxed)) {
+    }
+}
+
+double Histogram::getMax(void) const {
+    unsigned long long bits = _maxBits.load(std::memory_order_relaxed);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double Histogram::getPercentile(double p) const {
+    unsigned int count = getCount();
+    if (count == 0) {
+        return 0;
+    }
+
+    //rank of the value we are looking for, 1 based
+    unsigned int rank = (unsigned int)(p / 100.0 * count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    unsigned int seen = 0;
+    for (int i = 0; i < _numBuckets; i++) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            //the last bucket is open ended, the max is the better answer there
+            if (i == _numBuckets - 1) {
+                return getMax();
+            }
+            return i * _bucketWidth;
+        }
+    }
+    return getMax();
+}
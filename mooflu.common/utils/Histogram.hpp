@@ -0,0 +1,46 @@
+#pragma once
+// Description:
+//   Fixed size histogram with percentile queries.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <atomic>
+
+//Values are counted in buckets of equal width, values past the last
+//bucket are counted in it. add() is lock-free and allocation free, so it
+//can be called from any thread while another one reads percentiles.
+class Histogram {
+public:
+    Histogram(double bucketWidth, int numBuckets);
+    ~Histogram();
+
+    void add(double value);
+    void reset(void);
+
+    unsigned int getCount(void) const { return _count.load(std::memory_order_relaxed); }
+    double getMax(void) const;
+
+    //Lower edge of the bucket containing the p-th percentile (0..100),
+    //accurate to the bucket width. 0 if empty.
+    double getPercentile(double p) const;
+
+private:
+    Histogram(const Histogram&);
+    Histogram& operator=(const Histogram&);
+
+    double _bucketWidth;
+    int _numBuckets;
+    std::atomic<unsigned int>* _buckets;
+    std::atomic<unsigned int> _count;
+    std::atomic<unsigned long long> _maxBits;  //double bits, comparable for positive values
+};
@@ -43,7 +43,7 @@ public:
         }
     }
 
-    double getTime(void) {
+    double getTime(void) const {
         if (_isPaused) {
             return (_pausedAt);
         } else {
@@ -14,24 +14,16 @@
 // FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
 //
 
-#include "gettimeofday.hpp"
+#include <chrono>
 
 class Timer {
 public:
+    //Seconds since the first call, at full clock resolution. Monotonic, so
+    //wall clock adjustments (NTP, DST, user) don't make time jump.
     static double getTime(void) {
-        struct timeval tv;
-        static bool initialized = false;
-        static long startSeconds = 0;
-        static long startUSeconds = 0;
+        typedef std::chrono::steady_clock Clock;
+        static const Clock::time_point start = Clock::now();
 
-        gettimeofday(&tv, 0);
-
-        if (!initialized) {
-            startSeconds = tv.tv_sec;
-            startUSeconds = tv.tv_usec;
-            initialized = true;
-        }
-        long msecs = (tv.tv_sec - startSeconds) * 1000 + (tv.tv_usec - startUSeconds) / 1000;
-        return ((double)msecs / 1000.0);
+        return std::chrono::duration<double>(Clock::now() - start).count();
     }
 };
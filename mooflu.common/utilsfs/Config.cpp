@@ -15,6 +15,7 @@
 #include "Config.hpp"
 
 #include <stdlib.h>
+#include <sstream>
 
 #ifndef _MSC_VER
 #include <unistd.h>
@@ -24,6 +25,7 @@
 
 #include "Trace.hpp"
 #include "ResourceManager.hpp"
+#include "SaveQueue.hpp"
 #include "Tokenizer.hpp"
 #include "Value.hpp"
 #include "GetDataPath.hpp"
@@ -153,11 +155,13 @@ void Config::saveToFile(void) {
     const string configFile = getConfigFileName();
     LOG_INFO << "Saving Configuration to : " << configFile << endl;
 
-    zoStream outfile(configFile.c_str());
-
+    //serialize here, the file is written in the background
+    ostringstream outfile;
     outfile << "# This is a generated file. Edit carefully!" << endl;
 
     Yaml::Serialize(_yaml, outfile);
+
+    SaveQueueS::instance()->save(configFile, outfile.str());
 }
 
 template <typename T>
@@ -0,0 +1,183 @@
+// Description:
+//   Writes files in the background.
+//
+// Copyright (C) 2026 Frank Becker
+//
+#include "SaveQueue.hpp"
+#include "Trace.hpp"
+
+#include "SDL_thread.h"
+#include "SDL_mutex.h"
+#include <physfs.h>
+
+#include <stdio.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#if defined(EMSCRIPTEN)
+#include <emscripten.h>
+#endif
+
+using namespace std;
+
+SaveQueue::SaveQueue(void) :
+    _thread(0),
+    _mutex(0),
+    _wake(0),
+    _done(0),
+    _busy(false),
+    _quit(false) {
+    XTRACE();
+#if !defined(EMSCRIPTEN)
+    _mutex = SDL_CreateMutex();
+    _wake = SDL_CreateCond();
+    _done = SDL_CreateCond();
+    if (_mutex && _wake && _done) {
+        _thread = SDL_CreateThread(run, "SaveQueue", this);
+    }
+    if (!_thread) {
+        LOG_WARNING << "Unable to start save thread, saving synchronously: " << SDL_GetError() << endl;
+    }
+#endif
+}
+
+SaveQueue::~SaveQueue() {
+    XTRACE();
+    if (_thread) {
+        SDL_LockMutex(_mutex);
+        _quit = true;
+        SDL_CondSignal(_wake);
+        SDL_UnlockMutex(_mutex);
+
+        //the worker drains the queue before it exits
+        SDL_WaitThread(_thread, 0);
+    }
+
+    if (_done) {
+        SDL_DestroyCond(_done);
+    }
+    if (_wake) {
+        SDL_DestroyCond(_wake);
+    }
+    if (_mutex) {
+        SDL_DestroyMutex(_mutex);
+    }
+}
+
+void SaveQueue::save(const string& name, const string& data) {
+    const char* writeDir = PHYSFS_getWriteDir();
+    if (!writeDir) {
+        LOG_ERROR << "SaveQueue: no write directory for " << name << "\n";
+        return;
+    }
+
+    SaveJob job;
+    job.path = string(writeDir) + PHYSFS_getDirSeparator() + name;
+    job.data = data;
+
+    if (!_thread) {
+        writeFile(job);
+#if defined(EMSCRIPTEN)
+        //persist to IndexedDB, this does not block
+        EM_ASM(FS.syncfs(false, function(err) {
+            if (err) {
+                console.log('FS.syncfs error: ' + err)
+            }
+        }););
+#endif
+        return;
+    }
+
+    SDL_LockMutex(_mutex);
+    list<SaveJob>::iterator i;
+    for (i = _jobs.begin(); i != _jobs.end(); i++) {
+        if (i->path == job.path) {
+            i->data.swap(job.data);
+            break;
+        }
+    }
+    if (i == _jobs.end()) {
+        _jobs.push_back(job);
+    }
+    SDL_CondSignal(_wake);
+    SDL_UnlockMutex(_mutex);
+}
+
+void SaveQueue::flush(void) {
+    if (!_thread) {
+        return;
+    }
+
+    SDL_LockMutex(_mutex);
+    while (!_jobs.empty() || _busy) {
+        SDL_CondWait(_done, _mutex);
+    }
+    SDL_UnlockMutex(_mutex);
+}
+
+int SaveQueue::run(void* data) {
+    static_cast<SaveQueue*>(data)->writeJobs();
+    return 0;
+}
+
+void SaveQueue::writeJobs(void) {
+    SDL_LockMutex(_mutex);
+    for (;;) {
+        while (_jobs.empty() && !_quit) {
+            SDL_CondWait(_wake, _mutex);
+        }
+        if (_jobs.empty()) {
+            break;
+        }
+
+        SaveJob job;
+        job.path.swap(_jobs.front().path);
+        job.data.swap(_jobs.front().data);
+        _jobs.pop_front();
+        _busy = true;
+
+        SDL_UnlockMutex(_mutex);
+        writeFile(job);
+        SDL_LockMutex(_mutex);
+
+        _busy = false;
+        SDL_CondBroadcast(_done);
+    }
+    SDL_UnlockMutex(_mutex);
+}
+
+bool SaveQueue::writeFile(const SaveJob& job) {
+    string tmpPath = job.path + ".tmp";
+
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f) {
+        LOG_ERROR << "SaveQueue: unable to open " << tmpPath << "\n";
+        return false;
+    }
+
+    bool ok = (fwrite(job.data.data(), 1, job.data.size(), f) == job.data.size()) && (fflush(f) == 0);
+#if defined(_MSC_VER)
+    ok = ok && (_commit(_fileno(f)) == 0);
+#elif !defined(EMSCRIPTEN)
+    ok = ok && (fsync(fileno(f)) == 0);
+#endif
+    ok = (fclose(f) == 0) && ok;
+
+    if (ok) {
+#ifdef _MSC_VER
+        //rename does not replace existing files on Windows
+        remove(job.path.c_str());
+#endif
+        ok = rename(tmpPath.c_str(), job.path.c_str()) == 0;
+    }
+
+    if (!ok) {
+        LOG_ERROR << "SaveQueue: unable to write " << job.path << "\n";
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
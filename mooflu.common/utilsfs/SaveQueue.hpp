@@ -0,0 +1,55 @@
+#pragma once
+// Description:
+//   Writes files in the background.
+//
+// Copyright (C) 2026 Frank Becker
+//
+#include <list>
+#include <string>
+
+#include "Singleton.hpp"
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+
+//Callers hand over a complete snapshot of the file contents, so the worker
+//never touches live game state. Each file is written to a temp file, synced
+//to disk and renamed over the old one.
+class SaveQueue {
+    friend class Singleton<SaveQueue>;
+
+public:
+    //Queue 'data' to be written to 'name' in the write directory. A pending
+    //save of the same file is replaced.
+    void save(const std::string& name, const std::string& data);
+
+    //Block until all queued saves are written.
+    void flush(void);
+
+private:
+    ~SaveQueue();
+    SaveQueue(void);
+    SaveQueue(const SaveQueue&);
+    SaveQueue& operator=(const SaveQueue&);
+
+    struct SaveJob {
+        std::string path;
+        std::string data;
+    };
+
+    static int run(void* data);
+    void writeJobs(void);
+    static bool writeFile(const SaveJob& job);
+
+    SDL_Thread* _thread;
+    SDL_mutex* _mutex;
+    SDL_cond* _wake;
+    SDL_cond* _done;
+
+    std::list<SaveJob> _jobs;
+    bool _busy;
+    bool _quit;
+};
+
+typedef Singleton<SaveQueue> SaveQueueS;
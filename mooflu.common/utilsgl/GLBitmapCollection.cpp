@@ -17,16 +17,16 @@
 #include "GLBitmapCollection.hpp"
 
 #include "SDL_image.h"
+#include "SDL_endian.h"
 #include <zrwops.hpp>
 
 #include "Trace.hpp"
-#include "FindHash.hpp"
 #include "ResourceManager.hpp"
+#include "GLExtensionTextureCompressionS3TC.hpp"
 
-#include "gl3/ProgramManager.hpp"
-#include "gl3/Program.hpp"
-#include "gl3/Buffer.hpp"
-#include "gl3/VertexArray.hpp"
+#include "RenderQueue.hpp"
+
+#include "glm/glm.hpp"
 
 #include <memory>
 using namespace std;
@@ -36,19 +36,17 @@ GLBitmapCollection::GLBitmapCollection(void) :
     _bcNeedsCleanup(true),
     _bitmapCount(0),
     _textureSize(0.0),
-    _bitmapInfoMap(),
-    _color(1, 1, 1, 1),
-    _vao(0),
-    _vIndexBuf(0),
-    _vertBuf(0),
-    _texCoordBuf(0) {}
+    _color(1, 1, 1, 1) {
+    for (unsigned int i = 0; i < BITMAP_NAME_SLOTS; i++) {
+        _nameSlot[i] = EMPTY_NAME_SLOT;
+    }
+}
 
 GLBitmapCollection::~GLBitmapCollection() {
     //Note: A bit of a hack for iphone where all bitmap collections are merged into a single collection
     if (_bcNeedsCleanup) {
         delete _bitmapCollection;
     }
-    resetVAO();
 }
 
 void GLBitmapCollection::setColor(const vec4f& color) {
@@ -59,11 +57,61 @@ void GLBitmapCollection::setColor(float r, float g, float b, float a) {
     _color = vec4f(r, g, b, a);
 }
 
+//Load pre-compressed (cooked) bitmap if present and supported by GL
+bool GLBitmapCollection::LoadCompressedBitmapFile(const char* bitmapFile) {
+    XTRACE();
+    static int s3tcSupported = -1;
+
+    string ktxName = string(bitmapFile) + ".ktx";
+    if (!ResourceManagerS::instance()->hasResource(ktxName)) {
+        return false;
+    }
+
+    if (s3tcSupported < 0) {
+        GLExtensionTextureCompressionS3TC s3tc;
+        s3tcSupported = s3tc.isSupported() ? 1 : 0;
+    }
+    if (!s3tcSupported) {
+        return false;
+    }
+
+    int size = ResourceManagerS::instance()->getResourceSize(ktxName);
+    if (size <= 0) {
+        return false;
+    }
+
+    std::shared_ptr<ziStream> ktxPtr(ResourceManagerS::instance()->getInputStream(ktxName));
+    vector<char> buf(size);
+    ktxPtr->read(&buf[0], size);
+    if (ktxPtr->gcount() != size) {
+        LOG_WARNING << "Unable to read compressed bitmap: [" << ktxName << "]" << endl;
+        return false;
+    }
+
+    GLCompressedImage* img = GLCompressedImage::fromKTX(&buf[0], size);
+    if (!img) {
+        LOG_WARNING << "Failed to load compressed bitmap: [" << ktxName << "]" << endl;
+        return false;
+    }
+    LOG_DEBUG << "Compressed bitmap loaded: [" << ktxName << "] " << img->levels.size() << " levels." << endl;
+
+    //assuming texture is square
+    _textureSize = (float)img->width;
+
+    _bitmapCollection = new GLTexture(GL_TEXTURE_2D, img);
+
+    return true;
+}
+
 //Load bitmap
 bool GLBitmapCollection::LoadBitmapFile(const char* bitmapFile) {
     XTRACE();
     SDL_Surface* img;
 
+    if (LoadCompressedBitmapFile(bitmapFile)) {
+        return true;
+    }
+
     string bmName;
     if (ResourceManagerS::instance()->hasResource(string(bitmapFile) + ".png")) {
         bmName = string(bitmapFile) + ".png";
@@ -119,53 +167,9 @@ bool GLBitmapCollection::LoadBitmapFile(const char* bitmapFile) {
 
     _bitmapCollection = new GLTexture(GL_TEXTURE_2D, img, false);
 
-    initVAO();
-
     return true;
 }
 
-void GLBitmapCollection::resetVAO() {
-    delete _vao;
-    delete _vIndexBuf;
-    delete _vertBuf;
-    delete _texCoordBuf;
-}
-
-void GLBitmapCollection::initVAO() {
-    GLuint vi[4] = {0, 1, 2, 3};
-    _vIndexBuf = new Buffer();
-    _vIndexBuf->bind(GL_ELEMENT_ARRAY_BUFFER);
-    _vIndexBuf->setData(GL_ELEMENT_ARRAY_BUFFER, 4 * sizeof(GLuint), vi, GL_STATIC_DRAW);
-
-    _vertBuf = new Buffer();
-    _texCoordBuf = new Buffer();
-
-    Program* prog = ProgramManagerS::instance()->getProgram("texture");
-    prog->use();
-
-    GLint vertLoc = 0;  //glGetAttribLocation( prog->id(), "vertex");
-    GLint uvLoc = 1;    //glGetAttribLocation( prog->id(), "uv");
-
-    GLint textureUnit = glGetUniformLocation(prog->id(), "textureUnit");
-
-    _vao = new VertexArray();
-    _vao->bind();
-
-    glUniform1i(textureUnit, 0);
-
-    glEnableVertexAttribArray(vertLoc);
-    _vertBuf->bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(vertLoc, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-    glEnableVertexAttribArray(uvLoc);
-    _texCoordBuf->bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(uvLoc, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-    _vIndexBuf->bind(GL_ELEMENT_ARRAY_BUFFER);
-    _vao->unbind();
-    prog->release();
-}
-
 //Load single bitmap
 bool GLBitmapCollection::Load(const char* bitmapFile) {
     if (!LoadBitmapFile(bitmapFile)) {
@@ -181,10 +185,9 @@ bool GLBitmapCollection::Load(const char* bitmapFile) {
     bInfo.name[0] = '\0';
 
     _bitmapInfo[_bitmapCount] = bInfo;
-    string tmpName = bInfo.name;
-    LOG_DEBUG << "New bitmap: [" << tmpName << "] " << endl;
-    _bitmapInfoMap[tmpName] = &_bitmapInfo[_bitmapCount];
+    LOG_DEBUG << "New bitmap: [" << bInfo.name << "] " << endl;
     _bitmapCount++;
+    buildNameTable();
 
     return true;
 }
@@ -195,20 +198,131 @@ bool GLBitmapCollection::Load(const char* bitmapFile, const char* dataFile) {
         return false;
     }
 
-    if (!ResourceManagerS::instance()->hasResource(string(dataFile))) {
-        LOG_WARNING << "Bitmap data file [" << dataFile << "] not found." << endl;
+    int dataFileSize = ResourceManagerS::instance()->getResourceSize(string(dataFile));
+
+    //prefer the pre-baked index next to the data file: foo.data -> foo.idx
+    string indexFile(dataFile);
+    size_t epos = indexFile.rfind(".data");
+    if (epos != string::npos) {
+        indexFile.replace(epos, string::npos, ".idx");
+    } else {
+        indexFile += ".idx";
+    }
+
+    if (LoadIndexFile(indexFile, dataFileSize)) {
+        return true;
+    }
+
+    if (!LoadDataFile(dataFile)) {
         if (_bcNeedsCleanup) {
             delete _bitmapCollection;
+            _bitmapCollection = 0;
         }
         return false;
     }
+
+    return true;
+}
+
+static Sint32 readLE32(const char* p) {
+    Sint32 v;
+    memcpy(&v, p, sizeof(v));
+    return (Sint32)SDL_SwapLE32((Uint32)v);
+}
+
+static Uint16 readLE16(const char* p) {
+    Uint16 v;
+    memcpy(&v, p, sizeof(v));
+    return SDL_SwapLE16(v);
+}
+
+//Load pre-baked binary index.
+//Layout (little endian):
+//  "BMIX", version, source .data size, bitmap count, name slot count
+//  count * { xoff, yoff, xpos, ypos, width, height, char name[32] }
+//  slot count * Uint16 (index into bitmaps or 0xffff)
+bool GLBitmapCollection::LoadIndexFile(const string& indexFile, int dataFileSize) {
+    XTRACE();
+    const int headerSize = 5 * 4;
+    const int recordSize = 6 * 4 + 32;
+
+    if (!ResourceManagerS::instance()->hasResource(indexFile)) {
+        return false;
+    }
+
+    int size = ResourceManagerS::instance()->getResourceSize(indexFile);
+    if (size < headerSize) {
+        LOG_WARNING << "Bitmap index [" << indexFile << "] too small." << endl;
+        return false;
+    }
+
+    std::shared_ptr<ziStream> indexPtr(ResourceManagerS::instance()->getInputStream(indexFile));
+    vector<char> buf(size);
+    indexPtr->read(&buf[0], size);
+    if (indexPtr->gcount() != size) {
+        LOG_WARNING << "Unable to read bitmap index [" << indexFile << "]." << endl;
+        return false;
+    }
+
+    const char* p = &buf[0];
+    if (memcmp(p, "BMIX", 4) != 0 || (unsigned int)readLE32(p + 4) != BITMAP_INDEX_VERSION) {
+        LOG_WARNING << "Bitmap index [" << indexFile << "] has incorrect format." << endl;
+        return false;
+    }
+
+    if ((dataFileSize >= 0) && (readLE32(p + 8) != dataFileSize)) {
+        LOG_WARNING << "Bitmap index [" << indexFile << "] is stale. Using data file." << endl;
+        return false;
+    }
+
+    unsigned int count = (unsigned int)readLE32(p + 12);
+    unsigned int slots = (unsigned int)readLE32(p + 16);
+    if ((count > MAX_BITMAPS) || (headerSize + count * recordSize + slots * 2 != (unsigned int)size)) {
+        LOG_WARNING << "Bitmap index [" << indexFile << "] has incorrect format." << endl;
+        return false;
+    }
+
+    p += headerSize;
+    for (unsigned int i = 0; i < count; i++) {
+        BitmapInfo& bInfo = _bitmapInfo[i];
+        bInfo.xoff = readLE32(p);
+        bInfo.yoff = readLE32(p + 4);
+        bInfo.xpos = readLE32(p + 8);
+        bInfo.ypos = readLE32(p + 12);
+        bInfo.width = readLE32(p + 16);
+        bInfo.height = readLE32(p + 20);
+        memcpy(bInfo.name, p + 24, 32);
+        bInfo.name[31] = '\0';
+        p += recordSize;
+    }
+    _bitmapCount = count;
+
+    if (slots == BITMAP_NAME_SLOTS) {
+        for (unsigned int i = 0; i < slots; i++) {
+            _nameSlot[i] = readLE16(p + i * 2);
+        }
+    } else {
+        //baked with a different table size, hash the names here
+        buildNameTable();
+    }
+
+    LOG_DEBUG << "Bitmap index [" << indexFile << "] read OK. " << _bitmapCount << " bitmaps." << endl;
+
+    return true;
+}
+
+//Parse text data file
+bool GLBitmapCollection::LoadDataFile(const char* dataFile) {
+    if (!ResourceManagerS::instance()->hasResource(string(dataFile))) {
+        LOG_WARNING << "Bitmap data file [" << dataFile << "] not found." << endl;
+        return false;
+    }
     std::shared_ptr<ziStream> datainfilePtr(ResourceManagerS::instance()->getInputStream(string(dataFile)));
     ziStream& datainfile = *datainfilePtr;
 
     LOG_DEBUG << "Reading: [" << dataFile << "]." << endl;
     _bitmapCount = 0;
-    bool fileRead = false;
-    while (!fileRead) {
+    for (;;) {
         BitmapInfo tmpBInfo;
         string line;
         if (getline(datainfile, line).eof()) {
@@ -235,33 +349,63 @@ bool GLBitmapCollection::Load(const char* bitmapFile, const char* dataFile) {
         if (n != 7) {
             LOG_WARNING << "Data file [" << dataFile << "] has incorrect format." << endl;
             break;
-        } else {
-            _bitmapInfo[_bitmapCount] = tmpBInfo;
-            string tmpName = tmpBInfo.name;
-            LOG_DEBUG << "New bitmap: [" << tmpName << "] " << endl;
-            _bitmapInfoMap[tmpName] = &_bitmapInfo[_bitmapCount];
-            _bitmapCount++;
         }
 
-        if (_bitmapCount > MAX_BITMAPS) {
+        if (_bitmapCount >= MAX_BITMAPS) {
             LOG_ERROR << "Maximum number (" << MAX_BITMAPS << ") of bitmaps per collection exceeded." << endl;
-            fileRead = true;
+            break;
         }
+
+        _bitmapInfo[_bitmapCount] = tmpBInfo;
+        LOG_DEBUG << "New bitmap: [" << tmpBInfo.name << "] " << endl;
+        _bitmapCount++;
     }
+    buildNameTable();
 
     LOG_DEBUG << "Bitmap read OK." << endl;
 
     return true;
 }
 
-//Get index of bitmap with the given name
-int GLBitmapCollection::getIndex(const string& name) {
-    XTRACE();
+unsigned int GLBitmapCollection::hashName(const char* name) {
+    unsigned int h = 2166136261u;
+    while (*name) {
+        h ^= (unsigned char)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void GLBitmapCollection::buildNameTable(void) {
+    for (unsigned int i = 0; i < BITMAP_NAME_SLOTS; i++) {
+        _nameSlot[i] = EMPTY_NAME_SLOT;
+    }
+
     for (unsigned int i = 0; i < _bitmapCount; i++) {
-        if (name == _bitmapInfo[i].name) {
-            return (int)i;
+        const char* name = _bitmapInfo[i].name;
+        unsigned int slot = hashName(name) & (BITMAP_NAME_SLOTS - 1);
+        while (_nameSlot[slot] != EMPTY_NAME_SLOT) {
+            if (strcmp(_bitmapInfo[_nameSlot[slot]].name, name) == 0) {
+                //duplicate name, first one wins
+                break;
+            }
+            slot = (slot + 1) & (BITMAP_NAME_SLOTS - 1);
+        }
+        if (_nameSlot[slot] == EMPTY_NAME_SLOT) {
+            _nameSlot[slot] = (unsigned short)i;
         }
     }
+}
+
+int GLBitmapCollection::findName(const char* name) const {
+    unsigned int slot = hashName(name) & (BITMAP_NAME_SLOTS - 1);
+    while (_nameSlot[slot] != EMPTY_NAME_SLOT) {
+        unsigned short index = _nameSlot[slot];
+        if ((index < _bitmapCount) && (strcmp(_bitmapInfo[index].name, name) == 0)) {
+            return (int)index;
+        }
+        slot = (slot + 1) & (BITMAP_NAME_SLOTS - 1);
+    }
 
     return -1;
 }
@@ -280,34 +424,21 @@ void GLBitmapCollection::Draw(const unsigned int index, const float& x, const fl
 void GLBitmapCollection::Draw(const string& name, const float& x, const float& y, const float& scalex,
                               const float& scaley, const float& z) {
     //    cout << "Drawing bitmap " << name << endl;
-    BitmapInfo* bmInfo = findHash<const string>(name, _bitmapInfoMap);
+    int index = findName(name.c_str());
 
-    if (!bmInfo) {
+    if (index < 0) {
         cerr << "Unable to fill GLBitmapCollection::Draw request for " << name << endl;
         return;
     }
 
-    _Draw(*bmInfo, x, y, z, scalex, scaley);
+    _Draw(_bitmapInfo[index], x, y, z, scalex, scaley);
 }
 
 void GLBitmapCollection::Draw(unsigned int index, const vec2f& ll, const vec2f& ur) {
     const BitmapInfo& bitmapInfo = _bitmapInfo[index];
 
-    float tx, ty, fxsize, fysize;
-
-    fxsize = (float)bitmapInfo.width / _textureSize;
-    fysize = (float)bitmapInfo.height / _textureSize;
-    tx = (float)bitmapInfo.xpos / _textureSize;
-    ty = (float)bitmapInfo.ypos / _textureSize;
-
-    GLfloat z = 0.0;
-    GLfloat squareVertices[] = {
-        ll.x(), ll.y(), z, ur.x(), ll.y(), z, ur.x(), ur.y(), z, ll.x(), ur.y(), z,
-    };
-
-    GLfloat squareTexCoords[] = {tx, ty + fysize, tx + fxsize, ty + fysize, tx + fxsize, ty, tx, ty};
-
-    _Draw(squareVertices, squareTexCoords);
+    addSprite(bitmapInfo, (ll.x() + ur.x()) * 0.5f, (ll.y() + ur.y()) * 0.5f, 0.0f, ur.x() - ll.x(), ur.y() - ll.y(),
+              0.0f);
 }
 
 //Draw using bitmap info
@@ -315,32 +446,11 @@ void GLBitmapCollection::_Draw(const BitmapInfo& bitmapInfo, const float& x, con
                                const float& scalex, const float& scaley) {
     XTRACE();
 
-    float tx, ty, fxsize, fysize, ay;
-    float dxsize, dysize;
-
-    dxsize = (float)bitmapInfo.width * scalex;
-    dysize = (float)bitmapInfo.height * scaley;
-    ay = (float)(bitmapInfo.height - bitmapInfo.yoff) * scaley;
-    fxsize = (float)bitmapInfo.width / _textureSize;
-    fysize = (float)bitmapInfo.height / _textureSize;
-    tx = (float)bitmapInfo.xpos / _textureSize;
-    ty = (float)bitmapInfo.ypos / _textureSize;
-
-    GLfloat squareVertices[] = {
-        x       ,y+ay       ,z,
-        x+dxsize,y+ay       ,z,
-        x+dxsize,y+ay-dysize,z,
-        x       ,y+ay-dysize,z
-    };
-
-    GLfloat squareTexCoords[] = {
-        tx       ,ty,
-        tx+fxsize,ty,
-        tx+fxsize,ty+fysize,
-        tx       ,ty+fysize
-    };
-
-    _Draw(squareVertices, squareTexCoords);
+    float dxsize = (float)bitmapInfo.width * scalex;
+    float dysize = (float)bitmapInfo.height * scaley;
+    float ay = (float)(bitmapInfo.height - bitmapInfo.yoff) * scaley;
+
+    addSprite(bitmapInfo, x + dxsize * 0.5f, y + ay - dysize * 0.5f, z, dxsize, dysize, 0.0f);
 }
 
 //Draw centered using bitmap index
@@ -357,14 +467,14 @@ void GLBitmapCollection::DrawC(const unsigned int index, const float& x, const f
 void GLBitmapCollection::DrawC(const string& name, const float& x, const float& y, const float& scalex,
                                const float& scaley, const float& z) {
     //    cout << "Drawing bitmap " << name << endl;
-    BitmapInfo* bmInfo = findHash<const string>(name, _bitmapInfoMap);
+    int index = findName(name.c_str());
 
-    if (!bmInfo) {
+    if (index < 0) {
         cerr << "Unable to fill GLBitmapCollection::Draw request for " << name << endl;
         return;
     }
 
-    _DrawC(*bmInfo, x, y, z, scalex, scaley);
+    _DrawC(_bitmapInfo[index], x, y, z, scalex, scaley);
 }
 
 //Draw centered using bitmap info
@@ -372,54 +482,37 @@ void GLBitmapCollection::_DrawC(const BitmapInfo& bitmapInfo, const float& x, co
                                 const float& scalex, const float& scaley) {
     XTRACE();
 
-    float tx, ty, fxsize, fysize;
-    float dxsize, dysize;
-
-    dxsize = (float)bitmapInfo.width * scalex * 0.5f;
-    dysize = (float)bitmapInfo.height * scaley * 0.5f;
-    fxsize = (float)bitmapInfo.width / _textureSize;
-    fysize = (float)bitmapInfo.height / _textureSize;
-    tx = (float)bitmapInfo.xpos / _textureSize;
-    ty = (float)bitmapInfo.ypos / _textureSize;
-
-    GLfloat squareVertices[] = {
-        x-dxsize,y+dysize,z,
-        x+dxsize,y+dysize,z,
-        x+dxsize,y-dysize,z,
-        x-dxsize,y-dysize,z
-    };
-
-    GLfloat squareTexCoords[] = {
-        tx       ,ty,
-        tx+fxsize,ty,
-        tx+fxsize,ty+fysize,
-        tx       ,ty+fysize
-    };
-
-    _Draw(squareVertices, squareTexCoords);
+    addSprite(bitmapInfo, x, y, z, (float)bitmapInfo.width * scalex, (float)bitmapInfo.height * scaley, 0.0f);
 }
 
-void GLBitmapCollection::_Draw(GLfloat squareVertices[], GLfloat squareTexCoords[]) {
-    bind();
-
-    Program* prog = ProgramManagerS::instance()->getProgram("texture");
-    prog->use();  //needed to set uniforms
-
-    GLint color = glGetUniformLocation(prog->id(), "aColor");
-    glUniform4fv(color, 1, _color.array);
-
-    GLint withTexture = glGetUniformLocation(prog->id(), "withTexture");
-    glUniform1i(withTexture, 1);
-
-    _vao->bind();
-    _vertBuf->bind(GL_ARRAY_BUFFER);
-    _vertBuf->setData(GL_ARRAY_BUFFER, 4 * 3 * sizeof(GLfloat), squareVertices, GL_STATIC_DRAW);
-
-    _texCoordBuf->bind(GL_ARRAY_BUFFER);
-    _texCoordBuf->setData(GL_ARRAY_BUFFER, 4 * 2 * sizeof(GLfloat), squareTexCoords, GL_STATIC_DRAW);
+//Draw centred and rotated using bitmap index
+void GLBitmapCollection::DrawInstanced(unsigned int index, const float& x, const float& y, const float& scalex,
+                                       const float& scaley, const float& z, const float& rotation) {
+    if (index >= _bitmapCount) {
+        return;
+    }
 
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    _vao->unbind();
+    const BitmapInfo& bitmapInfo = _bitmapInfo[index];
+    addSprite(bitmapInfo, x, y, z, (float)bitmapInfo.width * scalex, (float)bitmapInfo.height * scaley,
+              glm::radians(rotation));
+}
 
-    prog->release();
+//Queue a sprite centred at (x,y,z) with the given size and rotation (radians)
+void GLBitmapCollection::addSprite(const BitmapInfo& bitmapInfo, float x, float y, float z, float width, float height,
+                                   float rotation) {
+    SpriteInstance& si = *RenderQueueS::instance()->addSprites(_bitmapCollection, 1);
+    si.position[0] = x;
+    si.position[1] = y;
+    si.position[2] = z;
+    si.rotation = rotation;
+    si.size[0] = width;
+    si.size[1] = height;
+    si.uvOffset[0] = (float)bitmapInfo.xpos / _textureSize;
+    si.uvOffset[1] = (float)bitmapInfo.ypos / _textureSize;
+    si.uvSize[0] = (float)bitmapInfo.width / _textureSize;
+    si.uvSize[1] = (float)bitmapInfo.height / _textureSize;
+    si.color[0] = _color.r();
+    si.color[1] = _color.g();
+    si.color[2] = _color.b();
+    si.color[3] = _color.a();
 }
@@ -22,11 +22,15 @@
 #include "vmmlib/vector.hpp"
 using namespace vmml;
 
-class Buffer;
-class VertexArray;
-
 const unsigned int MAX_BITMAPS = 512;
 
+//Name lookup table size. Power of two, kept at twice MAX_BITMAPS so the load factor stays <= 0.5
+const unsigned int BITMAP_NAME_SLOTS = MAX_BITMAPS * 2;
+const unsigned short EMPTY_NAME_SLOT = 0xffff;
+
+//Pre-baked binary index (see scripts/bakeBitmapIndex.py). Text .data file is the source of truth.
+const unsigned int BITMAP_INDEX_VERSION = 1;
+
 class GLBitmapCollection {
 
 public:
@@ -49,8 +53,8 @@ public:
     //Load single bitmap
     bool Load(const char* bitmapFile);
 
-    //Get index of bitmap with the given name
-    int getIndex(const std::string& name);
+    //Get index of bitmap with the given name, -1 if not found
+    int getIndex(const std::string& name) const { return findName(name.c_str()); }
 
     //Bind texture
     void bind(void) { _bitmapCollection->bind(); }
@@ -74,6 +78,10 @@ public:
     void DrawC(unsigned int index, const float& x, const float& y, const float& scalex, const float& scaley,
                const float& z = 0.0);
 
+    //Draw centred and rotated (degrees) using bitmap index
+    void DrawInstanced(unsigned int index, const float& x, const float& y, const float& scalex, const float& scaley,
+                       const float& z = 0.0, const float& rotation = 0.0);
+
     void setColor(const vec4f& color);
     void setColor(float r, float g, float b, float a);
 
@@ -89,12 +97,10 @@ public:
 
     void reset(void) {
         _bitmapCollection->reset();
-        resetVAO();
     }
 
     void reload(void) {
         _bitmapCollection->reload();
-        initVAO();
     }
 
 #ifndef IPHONE
@@ -108,12 +114,18 @@ protected:
     inline void _DrawC(const BitmapInfo& bmInfo, const float& x, const float& y, const float& z, const float& scalex,
                        const float& scaley);
 
-    void _Draw(GLfloat squareVertices[], GLfloat squareTexCoords[]);
-
-    void initVAO();
-    void resetVAO();
+    //Queue a sprite centred at (x,y,z) with the given size and rotation (radians), see RenderQueue
+    void addSprite(const BitmapInfo& bmInfo, float x, float y, float z, float width, float height, float rotation);
 
     bool LoadBitmapFile(const char* bitmapFile);
+    bool LoadCompressedBitmapFile(const char* bitmapFile);
+    bool LoadIndexFile(const std::string& indexFile, int dataFileSize);
+    bool LoadDataFile(const char* dataFile);
+
+    //FNV-1a, must match scripts/bakeBitmapIndex.py
+    static unsigned int hashName(const char* name);
+    void buildNameTable(void);
+    int findName(const char* name) const;
 
     GLTexture* _bitmapCollection;
     bool _bcNeedsCleanup;
@@ -121,15 +133,11 @@ protected:
     unsigned int _bitmapCount;
     float _textureSize;
 
-    hash_map<const std::string, BitmapInfo*, hash<const std::string>, std::equal_to<const std::string>> _bitmapInfoMap;
+    //open addressing (linear probing) name -> _bitmapInfo index
+    unsigned short _nameSlot[BITMAP_NAME_SLOTS];
 
     vec4f _color;
 
-    VertexArray* _vao;
-    Buffer* _vIndexBuf;
-    Buffer* _vertBuf;
-    Buffer* _texCoordBuf;
-
 private:
     GLBitmapCollection(const GLBitmapCollection&);
     GLBitmapCollection& operator=(const GLBitmapCollection&);
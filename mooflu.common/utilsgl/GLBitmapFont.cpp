@@ -18,106 +18,95 @@
 #include "Trace.hpp"
 #include "BitmapManager.hpp"
 
-#include "gl3/ProgramManager.hpp"
-#include "gl3/Program.hpp"
-#include "gl3/Buffer.hpp"
-#include "gl3/VertexArray.hpp"
-
+#include <math.h>
 #include <string>
 using namespace std;
 
-//Draw a string at (x,y) scaled by [scalex,scaley]
+//Queue a string at (x,y) scaled by [scalex,scaley] for batched drawing
 void GLBitmapFont::DrawString(const char* s, float x, float y, float scalex, float scaley) {
     XTRACE();
+    const TextLayout& layout = getLayout(s);
+    if (layout.glyphs.empty()) {
+        return;
+    }
 
-    unsigned char c;
-    int i, l;
-
-    l = (int)strlen(s);
-    bind();
+    SpriteInstance* glyphs = RenderQueueS::instance()->addSprites(_bitmapCollection, (int)layout.glyphs.size());
+
+    for (size_t i = 0; i < layout.glyphs.size(); i++) {
+        SpriteInstance& glyph = glyphs[i];
+        glyph = layout.glyphs[i];
+        glyph.position[0] = x + glyph.position[0] * scalex;
+        glyph.position[1] = y + glyph.position[1] * scaley;
+        glyph.size[0] *= scalex;
+        glyph.size[1] *= scaley;
+        glyph.color[0] = _color.r();
+        glyph.color[1] = _color.g();
+        glyph.color[2] = _color.b();
+        glyph.color[3] = _color.a();
+    }
+}
 
-    Program* prog = ProgramManagerS::instance()->getProgram("texture");
-    prog->use();  //needed to set uniforms
+//Determine width of string
+float GLBitmapFont::GetWidth(const char* s, float scalex) {
+    XTRACE();
+    return getLayout(s).width * scalex;
+}
 
-    GLint color = glGetUniformLocation(prog->id(), "aColor");
-    glUniform4fv(color, 1, _color.array);
+//Lookup or build the unit scale layout of a string
+const GLBitmapFont::TextLayout& GLBitmapFont::getLayout(const char* s) {
+    hash_map<string, TextLayout>::iterator cached = _layoutCache.find(s);
+    if (cached != _layoutCache.end()) {
+        return cached->second;
+    }
 
-    GLint withTexture = glGetUniformLocation(prog->id(), "withTexture");
-    glUniform1i(withTexture, 1);
+    if (_layoutCache.size() >= MAX_TEXT_LAYOUTS) {
+        _layoutCache.clear();
+    }
+    TextLayout& layout = _layoutCache[s];
 
-    _vao->bind();
+    float tabwidth = 0;
+    if (_charInfo[32] != ((unsigned int)~0)) {
+        tabwidth = (float)(_bitmapInfo[_charInfo[32]].width * 8);
+    }
 
-    for (i = 0; i < l; i++) {
-        float dxsize, dysize;
-        c = s[i];
-        if (_charInfo[c] == ((unsigned int)~0)) {
-            //no bitmap for char
+    float x = 0;
+    for (const unsigned char* c = (const unsigned char*)s; *c; c++) {
+        if (*c == '\t') {
+            //tab stops are relative to the start of the string
+            if (tabwidth > 0) {
+                x = (floorf(x / tabwidth) + 1) * tabwidth;
+            }
             continue;
         }
-        BitmapInfo& charInfo = _bitmapInfo[_charInfo[c]];
-
-        if (c == 32) {
-            dxsize = (float)charInfo.width * scalex;
-        } else if (c == '\t') {
-            int tabwidth = (int)((float)(_bitmapInfo[_charInfo[32]].width * 8) * scalex);
-            int xpos = (int)x;
-            int trunc = xpos - (xpos % tabwidth);
-            x = (float)(trunc + tabwidth);
+        if (_charInfo[*c] == ((unsigned int)~0)) {
+            //no bitmap for char
             continue;
-        } else {  // don't do space
-            float tx, ty, fxsize, fysize, ay;
-
-            dxsize = (float)charInfo.width * scalex;
-            dysize = (float)charInfo.height * scaley;
-            ay = (float)(_totalHeight - charInfo.yoff) * scaley;
-            fxsize = (float)charInfo.width / _textureSize;
-            fysize = (float)charInfo.height / _textureSize;
-            tx = (float)charInfo.xpos / _textureSize;
-            ty = (float)charInfo.ypos / _textureSize;
-
-            GLfloat squareVertices[] = {
-                x       ,y+ay,          0,
-                x+dxsize,y+ay,          0,
-                x+dxsize,y+ay-dysize,   0,
-                x       ,y+ay-dysize,   0,
-            };
-
-            GLfloat squareTexCoords[] = {
-                tx       ,ty,
-                tx+fxsize,ty,
-                tx+fxsize,ty+fysize,
-                tx       ,ty+fysize
-            };
-
-            //glVertexPointer(2, GL_FLOAT, 0, squareVertices);
-            //glTexCoordPointer(2, GL_FLOAT, 0, squareTexCoords);
-
-            _vertBuf->bind(GL_ARRAY_BUFFER);
-            _vertBuf->setData(GL_ARRAY_BUFFER, 4 * 3 * sizeof(GLfloat), squareVertices, GL_STATIC_DRAW);
-
-            _texCoordBuf->bind(GL_ARRAY_BUFFER);
-            _texCoordBuf->setData(GL_ARRAY_BUFFER, 4 * 2 * sizeof(GLfloat), squareTexCoords, GL_STATIC_DRAW);
-
-            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
         }
-        x += dxsize;  //charInfo.width;
+        const BitmapInfo& charInfo = _bitmapInfo[_charInfo[*c]];
+
+        if (*c != 32) {  // don't do space
+            SpriteInstance glyph;
+            float w = (float)charInfo.width;
+            float h = (float)charInfo.height;
+            float top = (float)(_totalHeight - charInfo.yoff);
+
+            glyph.position[0] = x + w * 0.5f;
+            glyph.position[1] = top - h * 0.5f;
+            glyph.position[2] = 0;
+            glyph.rotation = 0;
+            glyph.size[0] = w;
+            glyph.size[1] = h;
+            glyph.uvOffset[0] = (float)charInfo.xpos / _textureSize;
+            glyph.uvOffset[1] = (float)charInfo.ypos / _textureSize;
+            glyph.uvSize[0] = w / _textureSize;
+            glyph.uvSize[1] = h / _textureSize;
+            layout.glyphs.push_back(glyph);
+        }
+        x += (float)charInfo.width;
     }
+    layout.width = x;
 
-    _vao->unbind();
-
-    prog->release();
-}
-
-//Determine width of string (doesn't take TABs into account, yet!)
-float GLBitmapFont::GetWidth(const char* s, float scalex) {
-    XTRACE();
-    int width = 0;
-    size_t l = strlen(s);
-    for (size_t i = 0; i < l; i++) {
-        //FIXME: handle TABs
-        width += _bitmapInfo[_charInfo[(int)s[i]]].width;
-    }
-    return ((float)width * scalex);
+    return layout;
 }
 
 float GLBitmapFont::GetHeight(float scaley) {
@@ -139,6 +128,7 @@ bool GLBitmapFont::Load(const char* bitmapFile, const char* dataFile) {
     }
     _bitmapCount = bitmaps->_bitmapCount;
     _textureSize = bitmaps->_textureSize;
+    buildNameTable();
 
     string bitmapFileName(bitmapFile);
     size_t epos = bitmapFileName.find_last_of('.');
@@ -15,6 +15,13 @@
 //
 
 #include "GLBitmapCollection.hpp"
+#include "RenderQueue.hpp"
+
+#include <string>
+#include <vector>
+
+//Upper bound for cached string layouts. Cache is simply dropped when full.
+const unsigned int MAX_TEXT_LAYOUTS = 512;
 
 class GLBitmapFont : public GLBitmapCollection {
 public:
@@ -28,10 +35,10 @@ public:
 
     virtual ~GLBitmapFont() {}
 
-    //Draw a string at (x,y) scaled by [scalex,scaley]
+    //Queue a string at (x,y) scaled by [scalex,scaley] for batched drawing
     void DrawString(const char* s, float x, float y, float scalex, float scaley);
 
-    //Determine width of string (doesn't take TABs into account, yet!)
+    //Determine width of string
     float GetWidth(const char* s, float scalex);
 
     float GetHeight(float scaley);
@@ -43,6 +50,16 @@ private:
     GLBitmapFont(const GLBitmapFont&);
     GLBitmapFont& operator=(const GLBitmapFont&);
 
+    //Glyph quads of a string at unit scale, relative to the string origin
+    struct TextLayout {
+        std::vector<SpriteInstance> glyphs;
+        float width;
+    };
+
+    const TextLayout& getLayout(const char* s);
+
     int _totalHeight;
     unsigned int _charInfo[256];
+
+    hash_map<std::string, TextLayout> _layoutCache;
 };
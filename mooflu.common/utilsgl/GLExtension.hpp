@@ -21,6 +21,7 @@ extern "C" { typedef void (*__GL_EXT_FuncPtr)(); }
 #include "SDL.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include <GL/glew.h>
 #include "Trace.hpp"
@@ -30,7 +31,8 @@ extern "C" { typedef void (*__GL_EXT_FuncPtr)(); }
 
 class GLExtension {
 public:
-    GLExtension(const char* extensionName) {
+    //exactMatch compares whole extension names instead of looking for a substring
+    GLExtension(const char* extensionName, bool exactMatch = false) {
         //check if extension is supported
         _isSupported = false;
 
@@ -38,7 +40,8 @@ public:
         glGetIntegerv(GL_NUM_EXTENSIONS, &n);
         for (GLint i = 0; i < n; i++) {
             const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
-            if (strstr(extension, extensionName)) {
+            bool found = exactMatch ? (strcmp(extension, extensionName) == 0) : (strstr(extension, extensionName) != 0);
+            if (found) {
                 LOG_INFO << "Supported: [" << extensionName << "]\n";
                 _isSupported = true;
                 break;
@@ -0,0 +1,29 @@
+#pragma once
+// Description:
+//   Wrapper for S3TC (DXT) compressed texture extension.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include "GLExtension.hpp"
+
+class GLExtensionTextureCompressionS3TC : public GLExtension {
+public:
+    GLExtensionTextureCompressionS3TC(void) :
+        GLExtension(getName(), true) {}
+
+#if defined(EMSCRIPTEN)
+    virtual const char* getName(void) { return "WEBGL_compressed_texture_s3tc"; }
+#else
+    virtual const char* getName(void) { return "GL_EXT_texture_compression_s3tc"; }
+#endif
+};
@@ -16,10 +16,14 @@
 
 #include "Trace.hpp"
 #include "TextureManager.hpp"
+#include "gl3/ErrorCheck.hpp"
+
+#include <string.h>
 
 //Construct texture given filename
 GLTexture::GLTexture(GLenum target, const char* fileName, bool mipmap) :
-    _target(target) {
+    _target(target),
+    _compressed(0) {
     XTRACE();
     SDL_Surface* image;
     if ((image = IMG_Load(fileName)) == 0) {
@@ -33,17 +37,29 @@ GLTexture::GLTexture(GLenum target, const char* fileName, bool mipmap) :
 
 //Construct texture given SDL surface
 GLTexture::GLTexture(GLenum target, SDL_Surface* img, bool mipmap) :
-    _target(target) {
+    _target(target),
+    _compressed(0) {
     XTRACE();
     init(img, mipmap);
 }
 
+//Construct texture given pre-compressed image (incl. mipmaps)
+GLTexture::GLTexture(GLenum target, GLCompressedImage* img) :
+    _target(target),
+    _image(0),
+    _compressed(img),
+    _mipmap(img->levels.size() > 1) {
+    XTRACE();
+    initCompressed();
+}
+
 GLTexture::~GLTexture() {
     XTRACE();
     TextureManagerS::instance()->removeTexture(this);
     if (_image) {
         SDL_FreeSurface(_image);
     }
+    delete _compressed;
 }
 
 void GLTexture::reset(void) {
@@ -51,9 +67,34 @@ void GLTexture::reset(void) {
 }
 
 void GLTexture::reload(void) {
+    if (_compressed) {
+        initCompressed();
+        return;
+    }
     init(_image, _mipmap);
 }
 
+//Upload pre-compressed image. No CPU side decoding or mipmap generation.
+void GLTexture::initCompressed(void) {
+    _textureID = TextureManagerS::instance()->addTexture(this);
+
+    bind();
+    glTexParameteri(_target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(_target, GL_TEXTURE_MIN_FILTER, _mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(_target, GL_TEXTURE_MAX_LEVEL, (GLint)_compressed->levels.size() - 1);
+
+    int w = _compressed->width;
+    int h = _compressed->height;
+    for (size_t i = 0; i < _compressed->levels.size(); i++) {
+        const std::string& level = _compressed->levels[i];
+        glCompressedTexImage2D(_target, (GLint)i, _compressed->internalFormat, w, h, 0, (GLsizei)level.size(),
+                               level.data());
+        w = (w > 1) ? w / 2 : 1;
+        h = (h > 1) ? h / 2 : 1;
+    }
+    GL_CHECKPOINT();
+}
+
 //Init texture with SDL surface
 void GLTexture::init(SDL_Surface* img, bool mipmap) {
     _image = img;
@@ -121,6 +162,7 @@ void GLTexture::init(SDL_Surface* img, bool mipmap) {
 #endif
         }
     }
+    GL_CHECKPOINT();
 }
 
 //get texture format
@@ -136,3 +178,75 @@ GLenum GLTexture::getGLTextureFormat(void) {
 
     return texFormat;
 }
+
+static Uint32 ktxUint32(const char* p, bool swap) {
+    Uint32 v;
+    memcpy(&v, p, sizeof(v));
+    if (swap) {
+        v = ((v >> 24) & 0xff) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+    }
+    return v;
+}
+
+//Parse KTX (version 1) file contents
+GLCompressedImage* GLCompressedImage::fromKTX(const char* data, int size) {
+    static const unsigned char ktxIdentifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31,
+                                                    0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    const int headerSize = 12 + 13 * 4;
+
+    if ((size < headerSize) || (memcmp(data, ktxIdentifier, sizeof(ktxIdentifier)) != 0)) {
+        LOG_ERROR << "Not a KTX file.\n";
+        return 0;
+    }
+
+    Uint32 endianness;
+    memcpy(&endianness, data + 12, sizeof(endianness));
+    bool swap = (endianness != 0x04030201);
+
+    const char* h = data + 16;
+    Uint32 glType = ktxUint32(h, swap);
+    Uint32 glInternalFormat = ktxUint32(h + 12, swap);
+    Uint32 pixelWidth = ktxUint32(h + 20, swap);
+    Uint32 pixelHeight = ktxUint32(h + 24, swap);
+    Uint32 pixelDepth = ktxUint32(h + 28, swap);
+    Uint32 numberOfArrayElements = ktxUint32(h + 32, swap);
+    Uint32 numberOfFaces = ktxUint32(h + 36, swap);
+    Uint32 numberOfMipmapLevels = ktxUint32(h + 40, swap);
+    Uint32 bytesOfKeyValueData = ktxUint32(h + 44, swap);
+
+    if ((glType != 0) || (pixelDepth != 0) || (numberOfArrayElements != 0) || (numberOfFaces != 1) ||
+        (pixelHeight == 0)) {
+        LOG_ERROR << "Unsupported KTX file. Only compressed 2D textures are supported.\n";
+        return 0;
+    }
+    if (numberOfMipmapLevels == 0) {
+        numberOfMipmapLevels = 1;
+    }
+
+    GLCompressedImage* img = new GLCompressedImage();
+    img->internalFormat = glInternalFormat;
+    img->width = (int)pixelWidth;
+    img->height = (int)pixelHeight;
+
+    int offset = headerSize + (int)bytesOfKeyValueData;
+    for (Uint32 i = 0; i < numberOfMipmapLevels; i++) {
+        if (offset + 4 > size) {
+            break;
+        }
+        int imageSize = (int)ktxUint32(data + offset, swap);
+        offset += 4;
+        if ((imageSize <= 0) || (offset + imageSize > size)) {
+            break;
+        }
+        img->levels.push_back(std::string(data + offset, imageSize));
+        offset += (imageSize + 3) & ~3;
+    }
+
+    if (img->levels.size() != numberOfMipmapLevels) {
+        LOG_ERROR << "Truncated KTX file.\n";
+        delete img;
+        return 0;
+    }
+
+    return img;
+}
@@ -22,6 +22,21 @@
 #endif
 
 #include "Trace.hpp"
+#include "gl3/StateCache.hpp"
+
+#include <string>
+#include <vector>
+
+//Pre-compressed image data, e.g. from a KTX file produced by scripts/cookTextures.py
+struct GLCompressedImage {
+    GLenum internalFormat;  //e.g. GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    int width;
+    int height;
+    std::vector<std::string> levels;  //mipmap chain, level 0 first
+
+    //Parse KTX (version 1) file contents. Returns 0 if not a valid compressed 2D KTX.
+    static GLCompressedImage* fromKTX(const char* data, int size);
+};
 
 class GLTextureI {
 public:
@@ -37,19 +52,23 @@ public:
     //target: GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP_ARB, etc.
     GLTexture(GLenum target, SDL_Surface* img, bool mipmap = false);
     GLTexture(GLenum target, const char* fileName, bool mipmap = false);
+    //takes ownership of img
+    GLTexture(GLenum target, GLCompressedImage* img);
 
     ~GLTexture();
 
-    void bind(void) { glBindTexture(_target, _textureID); }
+    void bind(void) { StateCache::bindTexture(_target, _textureID); }
+
+    void unbind(void) { StateCache::bindTexture(_target, 0); }
 
-    void unbind(void) { glBindTexture(_target, 0); }
+    GLuint id(void) const { return _textureID; }
 
     void reset(void);
     void reload(void);
 
-    int width() { return _image ? _image->w : 0; }
+    int width() { return _image ? _image->w : (_compressed ? _compressed->width : 0); }
 
-    int height() { return _image ? _image->h : 0; }
+    int height() { return _image ? _image->h : (_compressed ? _compressed->height : 0); }
 
 private:
     GLTexture(const GLTexture&);
@@ -58,8 +77,10 @@ private:
     GLuint _textureID;
     GLenum _target;
     SDL_Surface* _image;
+    GLCompressedImage* _compressed;
     bool _mipmap;
 
     GLenum getGLTextureFormat(void);
     void init(SDL_Surface* img, bool mipmap);
+    void initCompressed(void);
 };
@@ -39,9 +39,9 @@ public:
 
     ~GLTextureCubeMap();
 
-    void bind(void) { glBindTexture(GL_TEXTURE_CUBE_MAP_ARB, _textureID); }
+    void bind(void) { StateCache::bindTexture(GL_TEXTURE_CUBE_MAP_ARB, _textureID); }
 
-    void unbind(void) { glBindTexture(GL_TEXTURE_CUBE_MAP_ARB, 0); }
+    void unbind(void) { StateCache::bindTexture(GL_TEXTURE_CUBE_MAP_ARB, 0); }
 
     void reset(void);
     void reload(void);
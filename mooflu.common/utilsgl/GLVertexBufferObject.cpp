@@ -23,6 +23,8 @@
 #include "gl3/VertexArray.hpp"
 #include "gl3/MatrixStack.hpp"
 
+#include "RenderQueue.hpp"
+
 #include "Trace.hpp"
 
 GLVBO::GLVBO() :
@@ -34,7 +36,9 @@ GLVBO::GLVBO() :
     _vertBuf(0),
     _texBuf(0),
     _colorBuf(0),
-    _color(-1, -1, -1, 1) {}
+    _color(-1, -1, -1, 1),
+    _texture(0),
+    _pointSize(1.0f) {}
 
 GLVBO::~GLVBO() {
     reset();
@@ -132,6 +136,9 @@ void GLVBO::init(std::vector<vec4f>& verts, std::vector<vec2f>& texels, std::vec
 }
 
 void GLVBO::draw(GLenum mode) {
+    //keep painter's order with queued commands
+    RenderQueueS::instance()->flush();
+
     glm::mat4& modelview = MatrixStack::model.top();
     glm::mat4& projection = MatrixStack::projection.top();
 
@@ -147,36 +154,65 @@ void GLVBO::draw(GLenum mode) {
     _vao->unbind();
 }
 
+void GLVBO::record(GLenum mode, std::vector<vec4f>& verts, std::vector<vec2f>& texels, std::vector<vec4f>& colors) {
+    if (verts.empty()) {
+        return;
+    }
+
+    bool hasTexture = (texels.size() != 0);
+    if (hasTexture && (texels.size() != verts.size())) {
+        LOG_WARNING << "VBO: mismatching texels vector size\n";
+        hasTexture = false;
+    }
+    bool hasColor = (colors.size() != 0);
+    if (hasColor && (colors.size() != verts.size())) {
+        LOG_WARNING << "VBO: mismatching colors vector size\n";
+        hasColor = false;
+    }
+
+    //a negative color selects the per vertex colors
+    bool useVertexColor = (_color.r() < 0) && hasColor;
+    vec4f color = (_color.r() < 0) ? vec4f(1, 1, 1, 1) : _color;
+
+    GeometryVertex* v = RenderQueueS::instance()->addGeometry(mode, (int)verts.size(), hasTexture ? _texture : 0,
+                                                              _pointSize);
+    for (size_t i = 0; i < verts.size(); i++) {
+        const vec4f& c = useVertexColor ? colors[i] : color;
+        for (int j = 0; j < 4; j++) {
+            v[i].position[j] = verts[i][j];
+            v[i].color[j] = c[j];
+        }
+        v[i].uv[0] = hasTexture ? texels[i][0] : 0;
+        v[i].uv[1] = hasTexture ? texels[i][1] : 0;
+    }
+}
+
 void GLVBO::DrawQuad(const vec4f& p1, const vec4f& p2, const vec4f& p3, const vec4f& p4) {
     std::vector<vec4f> verts = {p1, p2, p3, p4};
     std::vector<vec4f> colors;
     std::vector<vec2f> texels;
-    init(verts, texels, colors);
-    draw(GL_TRIANGLE_FAN);
+    record(GL_TRIANGLE_FAN, verts, texels, colors);
 }
 
 void GLVBO::DrawQuad(const vec4f v[4]) {
     std::vector<vec4f> verts = {v[0], v[1], v[2], v[3]};
     std::vector<vec4f> colors;
     std::vector<vec2f> texels;
-    init(verts, texels, colors);
-    draw(GL_TRIANGLE_FAN);
+    record(GL_TRIANGLE_FAN, verts, texels, colors);
 }
 
 void GLVBO::DrawTexQuad(const vec4f v[4], const vec2f t[4]) {
     std::vector<vec4f> verts = {v[0], v[1], v[2], v[3]};
     std::vector<vec4f> colors;
     std::vector<vec2f> texels = {t[0], t[1], t[2], t[3]};
-    init(verts, texels, colors);
-    draw(GL_TRIANGLE_FAN);
+    record(GL_TRIANGLE_FAN, verts, texels, colors);
 }
 
 void GLVBO::DrawColorQuad(const vec4f v[4], const vec4f c[4]) {
     std::vector<vec4f> verts = { v[0], v[1], v[2], v[3] };
     std::vector<vec4f> colors = { c[0], c[1], c[2], c[3] };
     std::vector<vec2f> texels;
-    init(verts, texels, colors);
-    draw(GL_TRIANGLE_FAN);
+    record(GL_TRIANGLE_FAN, verts, texels, colors);
 }
 
 void GLVBO::DrawPoints(GLfloat* v, int numVerts) {
@@ -187,8 +223,7 @@ void GLVBO::DrawPoints(GLfloat* v, int numVerts) {
         verts.push_back(vec4f(v[i], v[i + 1], v[i + 2], 1));
     }
 
-    init(verts, texels, colors);
-    draw(GL_POINTS);
+    record(GL_POINTS, verts, texels, colors);
 }
 
 void GLVBO::DrawColorPoints(GLfloat* v, int numVerts, GLfloat* c, int numColors) {
@@ -203,6 +238,5 @@ void GLVBO::DrawColorPoints(GLfloat* v, int numVerts, GLfloat* c, int numColors)
         colors.push_back(vec4f(c[i], c[i + 1], c[i + 2], 1));
     }
 
-    init(verts, texels, colors);
-    draw(GL_POINTS);
+    record(GL_POINTS, verts, texels, colors);
 }
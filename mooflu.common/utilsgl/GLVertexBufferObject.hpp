@@ -23,6 +23,7 @@ using namespace vmml;
 
 class Buffer;
 class VertexArray;
+class GLTexture;
 
 class GLVBO {
 public:
@@ -35,8 +36,15 @@ public:
     void setColor(const vec4f& color);
     void setColor(float r, float g, float b, float a);
 
+    //texture for DrawTexQuad
+    void setTexture(GLTexture* texture) { _texture = texture; }
+    void setPointSize(float pointSize) { _pointSize = pointSize; }
+
+    //draw retained vertices now (see init)
     void draw(GLenum mode);
 
+    //Draw* functions below are queued, see RenderQueue
+
     void DrawQuad(const vec4f& p1, const vec4f& p2, const vec4f& p3, const vec4f& p4);
     void DrawQuad(const vec4f v[4]);
     void DrawTexQuad(const vec4f v[4], const vec2f t[4]);
@@ -46,6 +54,8 @@ public:
     void DrawColorPoints(GLfloat* verts, int numVerts, GLfloat* colors, int numColors);
 
 private:
+    void record(GLenum mode, std::vector<vec4f>& verts, std::vector<vec2f>& texels, std::vector<vec4f>& colors);
+
     bool _hasColor;
     bool _hasTexture;
 
@@ -58,4 +68,6 @@ private:
     Buffer* _colorBuf;
 
     vec4f _color;
+    GLTexture* _texture;
+    float _pointSize;
 };
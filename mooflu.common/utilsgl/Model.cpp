@@ -5,6 +5,8 @@
 //
 #include "Model.hpp"
 
+#include "SDL_endian.h"
+
 #include "Trace.hpp"
 #include "Tokenizer.hpp"
 #include "ResourceManager.hpp"
@@ -13,12 +15,14 @@
 #include "gl3/Program.hpp"
 #include "gl3/Buffer.hpp"
 #include "gl3/VertexArray.hpp"
-#include "gl3/MatrixStack.hpp"
+#include "gl3/ErrorCheck.hpp"
 
-#include "glm/ext.hpp"
+#include "RenderQueue.hpp"
 
 #include <memory>
 #include <vector>
+#include <unordered_map>
+#include <string.h>
 using namespace std;
 
 #ifdef IPHONE
@@ -26,6 +30,171 @@ float Model::MODEL_SCALE = 1.3f;
 #else
 float Model::MODEL_SCALE = 1.0f;
 #endif
+bool Model::OPTIMIZE_VERTEX_CACHE = true;
+
+//Cooked mesh, written by scripts/cookMeshes.py (little endian):
+//  "MESH", version, source .model size, vertex count, index count
+//  min, max, offset (3 floats each), char name[32]
+//  vertex count * 3 floats positions, 3 floats normals, 4 floats colors
+//  index count * Uint32
+const unsigned int MESH_VERSION = 1;
+const int MESH_HEADER_SIZE = 5 * 4 + 9 * 4 + 32;
+const int VERTEX_CACHE_SIZE = 16;
+
+namespace {
+//position, normal and color of a face corner
+struct Corner {
+    float v[10];
+};
+
+struct CornerHash {
+    size_t operator()(const Corner& c) const {
+        //FNV-1a
+        const unsigned char* p = (const unsigned char*)c.v;
+        unsigned int hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(c.v); i++) {
+            hash ^= p[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+};
+
+struct CornerEqual {
+    bool operator()(const Corner& a, const Corner& b) const { return memcmp(a.v, b.v, sizeof(a.v)) == 0; }
+};
+
+typedef unordered_map<Corner, GLuint, CornerHash, CornerEqual> CornerMap;
+
+Uint32 readLE32(const char* p) {
+    Uint32 v;
+    memcpy(&v, p, sizeof(v));
+    return SDL_SwapLE32(v);
+}
+
+float readFloat(const char* p) {
+    Uint32 bits = readLE32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+//Tipsify (Sander, Nehab, Barczak 2007). Emits the triangles around one
+//vertex at a time and picks the next vertex among those just emitted that
+//will still be in a post-transform cache of 'cacheSize' entries, so most
+//vertices are shaded once. Must match optimizeVertexCache in cookMeshes.py.
+void optimizeVertexCache(vector<GLuint>& indices, int numVerts, int cacheSize) {
+    int numTris = (int)indices.size() / 3;
+    if (numTris == 0) {
+        return;
+    }
+
+    //triangles using each vertex
+    vector<int> live(numVerts, 0);
+    for (size_t i = 0; i < indices.size(); i++) {
+        live[indices[i]]++;
+    }
+    vector<int> offset(numVerts + 1, 0);
+    for (int v = 0; v < numVerts; v++) {
+        offset[v + 1] = offset[v] + live[v];
+    }
+    vector<int> adjacency(indices.size());
+    vector<int> fill(offset.begin(), offset.end() - 1);
+    for (int t = 0; t < numTris; t++) {
+        for (int c = 0; c < 3; c++) {
+            adjacency[fill[indices[t * 3 + c]]++] = t;
+        }
+    }
+
+    vector<int> cacheTime(numVerts, 0);
+    vector<char> emitted(numTris, 0);
+    vector<int> deadEnd;
+    vector<int> candidates;
+    vector<GLuint> out;
+    out.reserve(indices.size());
+
+    int fanning = 0;
+    int stamp = cacheSize + 1;
+    int cursor = 1;
+    while (fanning >= 0) {
+        candidates.clear();
+        for (int a = offset[fanning]; a < offset[fanning + 1]; a++) {
+            int t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                int v = indices[t * 3 + c];
+                out.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (stamp - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = stamp;
+                    stamp++;
+                }
+            }
+            emitted[t] = 1;
+        }
+
+        //the candidate that stays in the cache longest
+        fanning = -1;
+        int best = -1;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            int v = candidates[i];
+            if (live[v] <= 0) {
+                continue;
+            }
+            int priority = 0;
+            if (stamp - cacheTime[v] + 2 * live[v] <= cacheSize) {
+                priority = stamp - cacheTime[v];
+            }
+            if (priority > best) {
+                best = priority;
+                fanning = v;
+            }
+        }
+
+        //dead end, try recently used vertices, then the input order
+        while ((fanning < 0) && !deadEnd.empty()) {
+            int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) {
+                fanning = v;
+            }
+        }
+        while ((fanning < 0) && (cursor < numVerts)) {
+            if (live[cursor] > 0) {
+                fanning = cursor;
+            }
+            cursor++;
+        }
+    }
+
+    indices.swap(out);
+}
+
+void addCorner(CornerMap& corners, const vec3f& vert, const vec3f& norm, const vec4f& color, vector<vec3f>& verts,
+               vector<vec3f>& norms, vector<vec4f>& colors, vector<GLuint>& indices) {
+    Corner c;
+    memcpy(&c.v[0], &vert, 3 * sizeof(float));
+    memcpy(&c.v[3], &norm, 3 * sizeof(float));
+    memcpy(&c.v[6], &color, 4 * sizeof(float));
+
+    CornerMap::iterator i = corners.find(c);
+    if (i != corners.end()) {
+        indices.push_back(i->second);
+        return;
+    }
+
+    GLuint index = (GLuint)verts.size();
+    corners[c] = index;
+    verts.push_back(vert);
+    norms.push_back(norm);
+    colors.push_back(color);
+    indices.push_back(index);
+}
+}
 
 Model::Model(void) :
     _numVerts(0),
@@ -158,7 +327,98 @@ bool Model::load(const char* filename) {
         }
     }
 
-    prepareModel();
+    buildMesh();
+    upload();
+
+    return true;
+}
+
+bool Model::loadMesh(const string& meshFile, int sourceSize) {
+    XTRACE();
+    if ((SDL_BYTEORDER == SDL_BIG_ENDIAN) || (MODEL_SCALE != 1.0f)) {
+        //the arrays are uploaded as they are read, and scaling them after
+        //would round differently from load()
+        return false;
+    }
+
+    if (!ResourceManagerS::instance()->hasResource(meshFile)) {
+        return false;
+    }
+
+    int size = ResourceManagerS::instance()->getResourceSize(meshFile);
+    if (size < MESH_HEADER_SIZE) {
+        LOG_WARNING << "Mesh [" << meshFile << "] too small." << endl;
+        return false;
+    }
+
+    std::shared_ptr<ziStream> meshPtr(ResourceManagerS::instance()->getInputStream(meshFile));
+    vector<char> buf(size);
+    meshPtr->read(&buf[0], size);
+    if (meshPtr->gcount() != size) {
+        LOG_WARNING << "Unable to read mesh [" << meshFile << "]." << endl;
+        return false;
+    }
+
+    const char* p = &buf[0];
+    if ((memcmp(p, "MESH", 4) != 0) || (readLE32(p + 4) != MESH_VERSION)) {
+        LOG_WARNING << "Mesh [" << meshFile << "] has incorrect format." << endl;
+        return false;
+    }
+
+    if ((sourceSize >= 0) && ((int)readLE32(p + 8) != sourceSize)) {
+        LOG_WARNING << "Mesh [" << meshFile << "] is stale. Using model file." << endl;
+        return false;
+    }
+
+    unsigned int numVerts = readLE32(p + 12);
+    unsigned int numIndices = readLE32(p + 16);
+    size_t expected = MESH_HEADER_SIZE + (size_t)numVerts * 10 * 4 + (size_t)numIndices * 4;
+    if ((numVerts > (unsigned int)size) || (numIndices > (unsigned int)size) || (expected != (size_t)size) ||
+        (numIndices % 3)) {
+        LOG_WARNING << "Mesh [" << meshFile << "] has incorrect format." << endl;
+        return false;
+    }
+
+    p += 20;
+    _min = vec3f(readFloat(p), readFloat(p + 4), readFloat(p + 8));
+    _max = vec3f(readFloat(p + 12), readFloat(p + 16), readFloat(p + 20));
+    _offset = vec3f(readFloat(p + 24), readFloat(p + 28), readFloat(p + 32));
+    p += 36;
+
+    char name[32];
+    memcpy(name, p, sizeof(name));
+    name[31] = '\0';
+    _name = name;
+    p += 32;
+
+    _meshVerts.resize(numVerts);
+    _meshNorms.resize(numVerts);
+    _meshColors.resize(numVerts);
+    _meshIndices.resize(numIndices);
+    for (unsigned int i = 0; i < numVerts; i++, p += 12) {
+        _meshVerts[i] = vec3f(readFloat(p), readFloat(p + 4), readFloat(p + 8));
+    }
+    for (unsigned int i = 0; i < numVerts; i++, p += 12) {
+        _meshNorms[i] = vec3f(readFloat(p), readFloat(p + 4), readFloat(p + 8));
+    }
+    for (unsigned int i = 0; i < numVerts; i++, p += 16) {
+        _meshColors[i] = vec4f(readFloat(p), readFloat(p + 4), readFloat(p + 8), readFloat(p + 12));
+    }
+    for (unsigned int i = 0; i < numIndices; i++, p += 4) {
+        _meshIndices[i] = readLE32(p);
+    }
+
+    for (unsigned int i = 0; i < numIndices; i++) {
+        if (_meshIndices[i] >= numVerts) {
+            LOG_WARNING << "Mesh [" << meshFile << "] has incorrect format." << endl;
+            _meshIndices.clear();
+            return false;
+        }
+    }
+
+    LOG_INFO << "  Mesh " << meshFile << " " << numVerts << " vertices, " << numIndices / 3 << " triangles" << endl;
+
+    upload();
 
     return true;
 }
@@ -328,51 +588,66 @@ void Model::reset(void) {
 //re-load model
 void Model::reload(void) {
     XTRACE();
-    prepareModel();
+    upload();
 }
 
-void Model::addTriangle(const vec4f& color, const vec4f& avgNormal, bool hasColor, int v1, int v2, int v3, bool smooth,
-                        std::vector<vec3f>& verts, std::vector<vec3f>& norms, std::vector<vec4f>& colors) {
-    int f[3];
-    f[0] = v1;
-    f[1] = v2;
-    f[2] = v3;
+void Model::buildMesh(void) {
+    _meshVerts.clear();
+    _meshNorms.clear();
+    _meshColors.clear();
+    _meshIndices.clear();
 
-    for (int i = 0; i < 3; i++) {
-        if (hasColor) {
-            colors.push_back(color);
-        } else {
-            colors.push_back(vec4f(1.0, 1.0, 1.0, 1.0));
+    CornerMap corners;
+    vec4f white(1.0, 1.0, 1.0, 1.0);
+    for (int i = 0; i < _numFaces; i++) {
+        const FaceInfo& face = _faces[i];
+        const vec4f& color = _numColors ? _colors[face.color] : white;
+
+        vec3f avgNormal = _norms[face.v1] + _norms[face.v2] + _norms[face.v3];
+        if (face.v4 != 0) {
+            avgNormal += _norms[face.v4];
         }
+        avgNormal.normalize();
 
-        if (smooth) {
-            norms.push_back(_norms[f[i]]);
-        } else {
-            norms.push_back(avgNormal);
+        int faceCorners[6] = {face.v1, face.v2, face.v3, face.v3, face.v4, face.v1};
+        int numCorners = (face.v4 != 0) ? 6 : 3;  //quads are split in two
+        for (int c = 0; c < numCorners; c++) {
+            int v = faceCorners[c];
+            addCorner(corners, _verts[v], face.smooth ? _norms[v] : avgNormal, color, _meshVerts, _meshNorms,
+                      _meshColors, _meshIndices);
         }
+    }
 
-        verts.push_back(_verts[f[i]]);
+    if (OPTIMIZE_VERTEX_CACHE) {
+        optimizeVertexCache(_meshIndices, (int)_meshVerts.size(), VERTEX_CACHE_SIZE);
     }
-    _numTriangles += 1;
-}
 
-void Model::draw() {
-    Program* prog = ProgramManagerS::instance()->getProgram("lighting");
-    prog->use();
+    LOG_INFO << "  " << _numFaces << " faces, " << _meshIndices.size() << " corners -> " << _meshVerts.size()
+             << " vertices" << endl;
 
-    GLint modelLoc = glGetUniformLocation(prog->id(), "model");
-    glm::mat4& modelview = MatrixStack::model.top();
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelview));
+    //only the mesh is needed from here on
+    vector<vec3f>().swap(_verts);
+    vector<vec3f>().swap(_norms);
+    vector<vec4f>().swap(_colors);
+    delete[] _faces;
+    _faces = 0;
+    _numFaces = 0;
+}
 
-    GLint objectColorLoc = glGetUniformLocation(prog->id(), "objectColor");
-    glUniform4fv(objectColorLoc, 1, _color.array);
+void Model::draw() {
+    RenderQueueS::instance()->addMesh(this, _color);
+}
 
+void Model::render(void) {
     _vao->bind();
     glDrawElements(GL_TRIANGLES, _numTriangles * 3, GL_UNSIGNED_INT, NULL);
     _vao->unbind();
 }
 
-void Model::prepareModel(void) {
+void Model::upload(void) {
+    reset();
+    _numTriangles = (int)_meshIndices.size() / 3;
+
     _vertBuf = new Buffer();
     _normBuf = new Buffer();
     _colorBuf = new Buffer();
@@ -400,48 +675,18 @@ void Model::prepareModel(void) {
     glVertexAttribPointer(colorLoc, 4, GL_FLOAT, GL_FALSE, 0, 0);
 
     _vIndexBuf->bind(GL_ELEMENT_ARRAY_BUFFER);
-
-    std::vector<vec3f> verts;
-    std::vector<vec3f> norms;
-    std::vector<vec2f> texels;
-    std::vector<vec4f> colors;
-
-    vec3f color(1.0, 0.0, 0.0);
-    for (int i = 0; i < _numFaces; i++) {
-        if (_numColors) {
-            color = _colors[_faces[i].color];
-        }
-
-        vec3f avgNormal = _norms[_faces[i].v1] + _norms[_faces[i].v2] + _norms[_faces[i].v3];
-        if (_faces[i].v4 != 0) {
-            avgNormal += _norms[_faces[i].v4];
-        }
-        avgNormal.normalize();
-
-        addTriangle(color, avgNormal, _numColors > 0, _faces[i].v1, _faces[i].v2, _faces[i].v3, _faces[i].smooth, verts,
-                    norms, colors);
-        if (_faces[i].v4 != 0)  //quad
-        {
-            addTriangle(color, avgNormal, _numColors > 0, _faces[i].v3, _faces[i].v4, _faces[i].v1, _faces[i].smooth,
-                        verts, norms, colors);
-        }
-    }
-    GLuint* vi = new GLuint[verts.size()];
-    for (GLuint i = 0; i < verts.size(); i++) {
-        vi[i] = i;
-    }
-    _vIndexBuf->bind(GL_ELEMENT_ARRAY_BUFFER);
-    _vIndexBuf->setData(GL_ELEMENT_ARRAY_BUFFER, verts.size() * sizeof(GLuint), vi, GL_STATIC_DRAW);
+    _vIndexBuf->setData(GL_ELEMENT_ARRAY_BUFFER, _meshIndices.size() * sizeof(GLuint), _meshIndices.data(),
+                        GL_STATIC_DRAW);
 
     _vertBuf->bind(GL_ARRAY_BUFFER);
-    _vertBuf->setData(GL_ARRAY_BUFFER, verts.size() * sizeof(vec3f), verts.data(), GL_STATIC_DRAW);
+    _vertBuf->setData(GL_ARRAY_BUFFER, _meshVerts.size() * sizeof(vec3f), _meshVerts.data(), GL_STATIC_DRAW);
 
     _normBuf->bind(GL_ARRAY_BUFFER);
-    _normBuf->setData(GL_ARRAY_BUFFER, norms.size() * sizeof(vec3f), norms.data(), GL_STATIC_DRAW);
+    _normBuf->setData(GL_ARRAY_BUFFER, _meshNorms.size() * sizeof(vec3f), _meshNorms.data(), GL_STATIC_DRAW);
 
     _colorBuf->bind(GL_ARRAY_BUFFER);
-    _colorBuf->setData(GL_ARRAY_BUFFER, colors.size() * sizeof(vec4f), colors.data(), GL_STATIC_DRAW);
+    _colorBuf->setData(GL_ARRAY_BUFFER, _meshColors.size() * sizeof(vec4f), _meshColors.data(), GL_STATIC_DRAW);
 
     _vao->unbind();
-    delete[] vi;
+    GL_CHECKPOINT();
 }
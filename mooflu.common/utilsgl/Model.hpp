@@ -14,6 +14,7 @@
 // FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
 //
 #include <string>
+#include <vector>
 
 #include "zStream.hpp"
 #include <GL/glew.h>
@@ -41,11 +42,17 @@ public:
     ~Model();
 
     static float MODEL_SCALE;  //global scale factor (mostly for iPhone)
+    static bool OPTIMIZE_VERTEX_CACHE;  //reorder triangles of text models for the post-transform cache
 
     //Load model from file
     bool load(const char* filename);
-    //go draw
+    //Load a cooked mesh (see scripts/cookMeshes.py). sourceSize is the size of
+    //the .model it was cooked from, -1 skips the staleness check.
+    bool loadMesh(const std::string& meshFile, int sourceSize);
+    //go draw (queued, see RenderQueue)
     void draw();
+    //draw now using the current program
+    void render(void);
     //re-load model (e.g. after toggling fullscreen).
     void reload(void);
     void reset(void);
@@ -78,10 +85,10 @@ private:
     Model(const Model&);
     Model& operator=(const Model&);
 
-    void prepareModel(void);
-
-    void addTriangle(const vec4f& color, const vec4f& avgNormal, bool hasColor, int v1, int v2, int v3, bool smooth,
-                     std::vector<vec3f>& verts, std::vector<vec3f>& norms, std::vector<vec4f>& colors);
+    //weld the face corners into an indexed mesh, then drop the parsed data
+    void buildMesh(void);
+    //create the GL buffers from the mesh
+    void upload(void);
 
     void verifyAndAssign(const int newVert, int& currVertVal);
 
@@ -101,6 +108,12 @@ private:
     std::vector<vec4f> _colors;
     FaceInfo* _faces;
 
+    //indexed mesh, one entry per distinct position/normal/color corner
+    std::vector<vec3f> _meshVerts;
+    std::vector<vec3f> _meshNorms;
+    std::vector<vec4f> _meshColors;
+    std::vector<GLuint> _meshIndices;
+
     vec3f _min;
     vec3f _max;
     vec3f _offset;
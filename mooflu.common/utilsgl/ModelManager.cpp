@@ -57,6 +57,19 @@ Model* ModelManager::load(const string& modelName) {
     Model* model = new Model;
 
     string modelFile = modelName + ".model";
+    string meshFile = modelName + ".mesh";
+
+    //prefer the cooked mesh unless the model changed since,
+    //fooX is cooked from foo.model (see Model::load)
+    string sourceFile = modelFile;
+    if (!modelName.empty() && (modelName[modelName.length() - 1] == 'X')) {
+        sourceFile = modelName.substr(0, modelName.length() - 1) + ".model";
+    }
+    ResourceManager& rm = *ResourceManagerS::instance();
+    int modelSize = rm.hasResource(sourceFile) ? rm.getResourceSize(sourceFile) : -1;
+    if (model->loadMesh(meshFile, modelSize)) {
+        return model;
+    }
 
     if (!model->load(modelFile.c_str())) {
         LOG_ERROR << "Unable to load: " << modelFile << endl;
@@ -0,0 +1,442 @@
+// Description:
+//   Deferred render commands. Sprites, text, geometry and meshes are recorded
+//   per layer and executed in one pass per frame. Layers where draw order
+//   doesn't matter are sorted by state, adjacent commands with the same state
+//   are batched and redundant program, texture, VAO, blend and uniform
+//   changes are skipped.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+#include "RenderQueue.hpp"
+
+#include "Trace.hpp"
+#include "GLTexture.hpp"
+#include "Model.hpp"
+
+#include "gl3/ProgramManager.hpp"
+#include "gl3/Program.hpp"
+#include "gl3/Buffer.hpp"
+#include "gl3/VertexArray.hpp"
+#include "gl3/MatrixStack.hpp"
+#include "gl3/StateCache.hpp"
+#include "gl3/ErrorCheck.hpp"
+#include "glm/ext.hpp"
+
+#include <algorithm>
+#include <cstddef>
+using namespace std;
+
+//sort key: layer (8 bits) | state (24 bits) | sequence (32 bits)
+//state is command type (3 bits) | texture (19 bits) | blend (2 bits), only set
+//in layers sorted by state, the others keep painter's order.
+const int LAYER_SHIFT = 56;
+const int STATE_SHIFT = 32;
+
+static bool isSortedByState(RenderLayer::RenderLayerEnum layer) {
+    //maze walls and items don't overlap, particles are small and short lived
+    return (layer == RenderLayer::eMaze) || (layer == RenderLayer::eItems) || (layer == RenderLayer::eParticles);
+}
+
+RenderQueue::RenderQueue(void) :
+    _layer(RenderLayer::eBackground),
+    _blend(BlendMode::eAlpha),
+    _spriteVao(0),
+    _cornerBuf(0),
+    _instanceBuf(0),
+    _geometryVao(0),
+    _vertexBuf(0) {
+    XTRACE();
+    _stats.commands = _stats.drawCalls = _stats.stateChanges = 0;
+    _frameStats = _stats;
+}
+
+RenderQueue::~RenderQueue() {
+    XTRACE();
+    reset();
+}
+
+void RenderQueue::reset(void) {
+    delete _spriteVao;
+    _spriteVao = 0;
+    delete _cornerBuf;
+    _cornerBuf = 0;
+    delete _instanceBuf;
+    _instanceBuf = 0;
+    delete _geometryVao;
+    _geometryVao = 0;
+    delete _vertexBuf;
+    _vertexBuf = 0;
+}
+
+void RenderQueue::initGL(void) {
+    //instanced sprites: unit quad (triangle strip) + per instance attributes, see sprite.vert.glsl
+    GLfloat corners[] = {-0.5f, 0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f};
+
+    _cornerBuf = new Buffer();
+    _instanceBuf = new Buffer();
+
+    _spriteVao = new VertexArray();
+    _spriteVao->bind();
+
+    glEnableVertexAttribArray(0);
+    _cornerBuf->bind(GL_ARRAY_BUFFER);
+    _cornerBuf->setData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+    GLsizei stride = sizeof(SpriteInstance);
+    _instanceBuf->bind(GL_ARRAY_BUFFER);
+
+    glEnableVertexAttribArray(1);  //position, rotation
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, position));
+    glVertexAttribDivisor(1, 1);
+
+    glEnableVertexAttribArray(2);  //size, uvOffset
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, size));
+    glVertexAttribDivisor(2, 1);
+
+    glEnableVertexAttribArray(3);  //uvSize
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, uvSize));
+    glVertexAttribDivisor(3, 1);
+
+    glEnableVertexAttribArray(4);  //color
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, color));
+    glVertexAttribDivisor(4, 1);
+
+    _spriteVao->unbind();
+
+    //geometry: interleaved vertex, uv, color, see texture.vert.glsl
+    _vertexBuf = new Buffer();
+
+    _geometryVao = new VertexArray();
+    _geometryVao->bind();
+
+    stride = sizeof(GeometryVertex);
+    _vertexBuf->bind(GL_ARRAY_BUFFER);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GeometryVertex, position));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GeometryVertex, uv));
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GeometryVertex, color));
+
+    _geometryVao->unbind();
+}
+
+unsigned int RenderQueue::currentMatrix(void) {
+    const glm::mat4& projection = MatrixStack::projection.top();
+    const glm::mat4& model = MatrixStack::model.top();
+
+    if (_models.empty() || (projection != _projections.back()) || (model != _models.back())) {
+        _projections.push_back(projection);
+        _models.push_back(model);
+    }
+
+    return (unsigned int)_models.size() - 1;
+}
+
+RenderQueue::RenderCommand& RenderQueue::addCommand(CommandType type, GLTexture* texture, float pointSize) {
+    RenderCommand cmd;
+    unsigned long long state = 0;
+    if (isSortedByState(_layer)) {
+        unsigned int textureId = texture ? (texture->id() & 0x7ffff) : 0;
+        state = ((unsigned long long)type << 21) | ((unsigned long long)textureId << 2) | (unsigned long long)_blend;
+    }
+    cmd.key = ((unsigned long long)_layer << LAYER_SHIFT) | (state << STATE_SHIFT) |
+              (unsigned long long)_commands.size();
+    cmd.type = type;
+    cmd.mode = GL_TRIANGLES;
+    cmd.texture = texture;
+    cmd.model = 0;
+    cmd.blend = _blend;
+    cmd.pointSize = pointSize;
+    cmd.matrix = currentMatrix();
+    cmd.first = 0;
+    cmd.count = 0;
+
+    _commands.push_back(cmd);
+    return _commands.back();
+}
+
+SpriteInstance* RenderQueue::addSprites(GLTexture* texture, int count) {
+    unsigned int matrix = currentMatrix();
+    unsigned int first = (unsigned int)_sprites.size();
+    _sprites.resize(first + count);
+
+    //consecutive sprites with the same state extend the previous command
+    if (!_commands.empty()) {
+        RenderCommand& last = _commands.back();
+        if ((last.type == eSprite) && (last.texture == texture) && (last.blend == _blend) &&
+            (last.matrix == matrix) && ((last.key >> LAYER_SHIFT) == (unsigned long long)_layer) &&
+            (last.first + last.count == first)) {
+            last.count += count;
+            return &_sprites[first];
+        }
+    }
+
+    RenderCommand& cmd = addCommand(eSprite, texture, 1.0f);
+    cmd.first = first;
+    cmd.count = count;
+
+    return &_sprites[first];
+}
+
+GeometryVertex* RenderQueue::addGeometry(GLenum mode, int count, GLTexture* texture, float pointSize) {
+    unsigned int matrix = currentMatrix();
+    unsigned int first = (unsigned int)_vertices.size();
+    _vertices.resize(first + count);
+
+    //lists (unlike strips and fans) can be appended to the previous command
+    bool isList = (mode == GL_POINTS) || (mode == GL_LINES) || (mode == GL_TRIANGLES);
+    if (isList && !_commands.empty()) {
+        RenderCommand& last = _commands.back();
+        if ((last.type == eGeometry) && (last.mode == mode) && (last.texture == texture) &&
+            (last.blend == _blend) && (last.pointSize == pointSize) && (last.matrix == matrix) &&
+            ((last.key >> LAYER_SHIFT) == (unsigned long long)_layer) && (last.first + last.count == first)) {
+            last.count += count;
+            return &_vertices[first];
+        }
+    }
+
+    RenderCommand& cmd = addCommand(eGeometry, texture, pointSize);
+    cmd.mode = mode;
+    cmd.first = first;
+    cmd.count = count;
+
+    return &_vertices[first];
+}
+
+void RenderQueue::addMesh(Model* model, const vec4f& color) {
+    RenderCommand& cmd = addCommand(eMesh, 0, 1.0f);
+    cmd.model = model;
+    cmd.color = color;
+}
+
+void RenderQueue::addClear(GLbitfield mask) {
+    RenderCommand& cmd = addCommand(eClear, 0, 1.0f);
+    cmd.mode = mask;
+}
+
+void RenderQueue::addViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    RenderCommand& cmd = addCommand(eViewport, 0, 1.0f);
+    cmd.viewport[0] = x;
+    cmd.viewport[1] = y;
+    cmd.viewport[2] = width;
+    cmd.viewport[3] = height;
+}
+
+void RenderQueue::flush(void) {
+    if (_commands.empty()) {
+        return;
+    }
+
+    if (!_spriteVao) {
+        initGL();
+    }
+
+    GL_CHECKPOINT();
+    sort(_commands.begin(), _commands.end(), sortByKey);
+
+    if (!_vertices.empty()) {
+        _vertexBuf->bind(GL_ARRAY_BUFFER);
+        _vertexBuf->setData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(GeometryVertex), &_vertices[0],
+                            GL_STREAM_DRAW);
+    }
+
+    ProgramManager* programManager = ProgramManagerS::instance();
+    Program* programs[eNumPrograms];
+    programs[eGeometry] = programManager->getProgram("texture");
+    programs[eSprite] = programManager->getProgram("sprite");
+    programs[eMesh] = programManager->getProgram("lighting");
+
+    GLint matrixLoc[eNumPrograms] = {-1, -1, -1};
+    unsigned int programMatrix[eNumPrograms] = {~0u, ~0u, ~0u};
+    GLint withTextureLoc = -1;
+    GLint objectColorLoc = -1;
+
+    Program* currentProgram = 0;
+    GLTexture* currentTexture = 0;
+    const VertexArray* currentVao = 0;
+    int currentBlend = -1;
+    int currentWithTexture = -1;
+    float currentPointSize = -1.0f;
+
+    for (size_t i = 0; i < _commands.size(); i++) {
+        const RenderCommand& cmd = _commands[i];
+
+        if (cmd.type == eClear) {
+            glClear(cmd.mode);
+            continue;
+        }
+        if (cmd.type == eViewport) {
+            glViewport(cmd.viewport[0], cmd.viewport[1], cmd.viewport[2], cmd.viewport[3]);
+            _stats.stateChanges++;
+            continue;
+        }
+
+        Program* prog = programs[cmd.type];
+        if (!prog) {
+            continue;
+        }
+        if (prog != currentProgram) {
+            prog->use();
+            currentProgram = prog;
+            _stats.stateChanges++;
+
+            if (matrixLoc[cmd.type] == -1) {
+                //first use of this program in this flush
+                GLint textureUnit = glGetUniformLocation(prog->id(), "textureUnit");
+                glUniform1i(textureUnit, 0);
+
+                if (cmd.type == eGeometry) {
+                    //color comes from the vertices
+                    GLint color = glGetUniformLocation(prog->id(), "aColor");
+                    glUniform4f(color, -1.0f, -1.0f, -1.0f, 1.0f);
+                    withTextureLoc = glGetUniformLocation(prog->id(), "withTexture");
+                } else if (cmd.type == eMesh) {
+                    objectColorLoc = glGetUniformLocation(prog->id(), "objectColor");
+                }
+                matrixLoc[cmd.type] =
+                    glGetUniformLocation(prog->id(), (cmd.type == eMesh) ? "model" : "modelViewMatrix");
+            }
+        }
+
+        if (cmd.blend != currentBlend) {
+            switch (cmd.blend) {
+                case BlendMode::eOpaque:
+                    StateCache::disable(GL_BLEND);
+                    break;
+                case BlendMode::eAdditive:
+                    StateCache::enable(GL_BLEND);
+                    StateCache::blendFunc(GL_SRC_ALPHA, GL_ONE);
+                    break;
+                default:
+                    StateCache::enable(GL_BLEND);
+                    StateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                    break;
+            }
+            currentBlend = cmd.blend;
+            _stats.stateChanges++;
+        }
+
+        if (cmd.texture && (cmd.texture != currentTexture)) {
+            cmd.texture->bind();
+            currentTexture = cmd.texture;
+            _stats.stateChanges++;
+        }
+
+        if (cmd.matrix != programMatrix[cmd.type]) {
+            if (cmd.type == eMesh) {
+                glUniformMatrix4fv(matrixLoc[cmd.type], 1, GL_FALSE, glm::value_ptr(_models[cmd.matrix]));
+            } else {
+                glm::mat4 modelViewMatrix = _projections[cmd.matrix] * _models[cmd.matrix];
+                glUniformMatrix4fv(matrixLoc[cmd.type], 1, GL_FALSE, glm::value_ptr(modelViewMatrix));
+            }
+            programMatrix[cmd.type] = cmd.matrix;
+            _stats.stateChanges++;
+        }
+
+        switch (cmd.type) {
+            case eSprite: {
+                //merge following sprite commands with the same state into one instanced draw
+                size_t last = i;
+                while ((last + 1 < _commands.size()) && (_commands[last + 1].type == eSprite) &&
+                       (_commands[last + 1].texture == cmd.texture) && (_commands[last + 1].blend == cmd.blend) &&
+                       (_commands[last + 1].matrix == cmd.matrix)) {
+                    last++;
+                }
+
+                const SpriteInstance* instances = &_sprites[cmd.first];
+                size_t count = cmd.count;
+                if (last != i) {
+                    _spriteBatch.clear();
+                    for (size_t j = i; j <= last; j++) {
+                        const RenderCommand& c = _commands[j];
+                        _spriteBatch.insert(_spriteBatch.end(), _sprites.begin() + c.first,
+                                            _sprites.begin() + c.first + c.count);
+                    }
+                    instances = &_spriteBatch[0];
+                    count = _spriteBatch.size();
+                    i = last;
+                }
+
+                if (currentVao != _spriteVao) {
+                    _spriteVao->bind();
+                    currentVao = _spriteVao;
+                    _stats.stateChanges++;
+                }
+                _instanceBuf->bind(GL_ARRAY_BUFFER);
+                _instanceBuf->setData(GL_ARRAY_BUFFER, count * sizeof(SpriteInstance), (void*)instances,
+                                      GL_STREAM_DRAW);
+                glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+                _stats.drawCalls++;
+            } break;
+
+            case eGeometry: {
+                int withTexture = cmd.texture ? 1 : 0;
+                if (withTexture != currentWithTexture) {
+                    glUniform1i(withTextureLoc, withTexture);
+                    currentWithTexture = withTexture;
+                    _stats.stateChanges++;
+                }
+#ifndef EMSCRIPTEN
+                if ((cmd.mode == GL_POINTS) && (cmd.pointSize != currentPointSize)) {
+                    glPointSize(cmd.pointSize);
+                    currentPointSize = cmd.pointSize;
+                    _stats.stateChanges++;
+                }
+#endif
+                if (currentVao != _geometryVao) {
+                    _geometryVao->bind();
+                    currentVao = _geometryVao;
+                    _stats.stateChanges++;
+                }
+                glDrawArrays(cmd.mode, cmd.first, cmd.count);
+                _stats.drawCalls++;
+            } break;
+
+            case eMesh:
+                glUniform4fv(objectColorLoc, 1, cmd.color.array);
+                cmd.model->render();
+                currentVao = 0;
+                _stats.drawCalls++;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    VertexArray::unbind();
+    Program::release();
+
+    _stats.commands += (int)_commands.size();
+    GL_CHECKPOINT();
+
+    _commands.clear();
+    _sprites.clear();
+    _vertices.clear();
+    _projections.clear();
+    _models.clear();
+}
+
+void RenderQueue::endFrame(void) {
+    flush();
+
+    _frameStats = _stats;
+    _stats.commands = _stats.drawCalls = _stats.stateChanges = 0;
+
+    _layer = RenderLayer::eBackground;
+    _blend = BlendMode::eAlpha;
+}
@@ -0,0 +1,171 @@
+#pragma once
+// Description:
+//   Deferred render commands. Sprites, text, geometry and meshes are recorded
+//   per layer and executed in one pass per frame. Layers where draw order
+//   doesn't matter are sorted by state, adjacent commands with the same state
+//   are batched and redundant program, texture, VAO, blend and uniform
+//   changes are skipped.
+//
+// Copyright (C) 2026 Frank Becker
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation;  either version 2 of the License,  or (at your option) any  later
+// version.
+//
+// This program is distributed in the hope that it will be useful,  but  WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details
+//
+
+#include <GL/glew.h>
+
+#include "Singleton.hpp"
+
+#include "vmmlib/vector.hpp"
+using namespace vmml;
+
+#include "glm/glm.hpp"
+
+#include <vector>
+
+class GLTexture;
+class Model;
+class Buffer;
+class VertexArray;
+
+//Layers are executed in order. eMaze, eItems and eParticles are sorted by
+//program, texture and blend (record order within the same state) and must not
+//hold clears or viewports. All other layers run in the order they were recorded.
+namespace RenderLayer {
+enum RenderLayerEnum {
+    eBackground,
+    eMaze,
+    eItems,
+    eParticles,
+    eActors,
+    eHud,
+    eHudText,
+    eMenu,
+    eMenuText,
+    eMenuParticles,
+    eOverlay,
+    eLAST
+};
+}
+
+namespace BlendMode {
+enum BlendModeEnum { eAlpha, eAdditive, eOpaque };
+}
+
+//per instance data for the "sprite" shader
+struct SpriteInstance {
+    GLfloat position[3];
+    GLfloat rotation;  //radians
+    GLfloat size[2];
+    GLfloat uvOffset[2];
+    GLfloat uvSize[2];
+    GLfloat color[4];
+};
+
+//per vertex data for the "texture" shader
+struct GeometryVertex {
+    GLfloat position[4];
+    GLfloat uv[2];
+    GLfloat color[4];
+};
+
+struct RenderStats {
+    int commands;
+    int drawCalls;
+    int stateChanges;
+};
+
+class RenderQueue {
+    friend class Singleton<RenderQueue>;
+
+public:
+    void setLayer(RenderLayer::RenderLayerEnum layer) { _layer = layer; }
+    RenderLayer::RenderLayerEnum getLayer(void) const { return _layer; }
+
+    void setBlend(BlendMode::BlendModeEnum blend) { _blend = blend; }
+
+    //Record count sprites under the current MatrixStack transform.
+    //Returns storage for the caller to fill, valid until the next add.
+    SpriteInstance* addSprites(GLTexture* texture, int count);
+
+    //Record geometry for the "texture" program (texture may be 0).
+    //Returns storage for the caller to fill, valid until the next add.
+    GeometryVertex* addGeometry(GLenum mode, int count, GLTexture* texture = 0, float pointSize = 1.0f);
+
+    //Record a mesh for the "lighting" program
+    void addMesh(Model* model, const vec4f& color);
+
+    //Record a glClear or glViewport, so it runs in order with the draws around it
+    void addClear(GLbitfield mask);
+    void addViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    //Execute and clear all recorded commands
+    void flush(void);
+
+    //Flush and latch the counts for this frame
+    void endFrame(void);
+
+    //Counts of the last completed frame
+    const RenderStats& getFrameStats(void) const { return _frameStats; }
+
+    //Release GL objects (e.g. on context re-creation). Re-created on next flush.
+    void reset(void);
+
+private:
+    virtual ~RenderQueue();
+    RenderQueue(void);
+    RenderQueue(const RenderQueue&);
+    RenderQueue& operator=(const RenderQueue&);
+
+    //the first eNumPrograms types draw with a program
+    enum CommandType { eGeometry, eSprite, eMesh, eNumPrograms, eClear = eNumPrograms, eViewport };
+
+    struct RenderCommand {
+        unsigned long long key;  //layer | state | sequence
+        CommandType type;
+        GLenum mode;  //clear mask for eClear
+        GLTexture* texture;
+        Model* model;
+        BlendMode::BlendModeEnum blend;
+        float pointSize;
+        unsigned int matrix;
+        unsigned int first;
+        unsigned int count;
+        vec4f color;
+        GLint viewport[4];
+    };
+
+    static bool sortByKey(const RenderCommand& a, const RenderCommand& b) { return a.key < b.key; }
+
+    RenderCommand& addCommand(CommandType type, GLTexture* texture, float pointSize);
+    unsigned int currentMatrix(void);
+    void initGL(void);
+
+    RenderLayer::RenderLayerEnum _layer;
+    BlendMode::BlendModeEnum _blend;
+
+    std::vector<RenderCommand> _commands;
+    std::vector<SpriteInstance> _sprites;
+    std::vector<GeometryVertex> _vertices;
+    std::vector<SpriteInstance> _spriteBatch;
+
+    std::vector<glm::mat4> _projections;
+    std::vector<glm::mat4> _models;
+
+    RenderStats _stats;
+    RenderStats _frameStats;
+
+    VertexArray* _spriteVao;
+    Buffer* _cornerBuf;
+    Buffer* _instanceBuf;
+    VertexArray* _geometryVao;
+    Buffer* _vertexBuf;
+};
+
+typedef Singleton<RenderQueue> RenderQueueS;
@@ -16,6 +16,7 @@
 
 #include "stdio.h"
 #include "Trace.hpp"
+#include "gl3/StateCache.hpp"
 
 TextureManager::TextureManager(void) :
     _textureCount(0) {
@@ -47,6 +48,7 @@ void TextureManager::removeTexture(GLTextureI* tex) {
     int slot = findTexture(tex);
     if (slot > 0) {
         texArray[slot] = 0;
+        StateCache::deleteTexture(texIDs[slot]);
         glDeleteTextures(1, &(texIDs[slot]));
         _textureCount--;
     }
@@ -1,10 +1,13 @@
 #include "Buffer.hpp"
 
+#include "StateCache.hpp"
+
 Buffer::Buffer() {
     glGenBuffers(1, &_id);
 }
 
 Buffer::~Buffer() {
+    StateCache::deleteBuffer(_id);
     glDeleteBuffers(1, &_id);
 }
 
@@ -13,11 +16,11 @@ GLuint Buffer::id() const {
 }
 
 void Buffer::bind(const GLenum target) const {
-    glBindBuffer(target, id());
+    StateCache::bindBuffer(target, id());
 }
 
 void Buffer::unbind(const GLenum target) {
-    glBindBuffer(target, 0);
+    StateCache::bindBuffer(target, 0);
 }
 
 void Buffer::unbind(const GLenum target, const GLuint index) {
@@ -0,0 +1,91 @@
+#include "ErrorCheck.hpp"
+
+#include "Trace.hpp"
+
+using namespace std;
+
+GLErrorMode::GLErrorModeEnum ErrorCheck::_mode = GLErrorMode::eOff;
+int ErrorCheck::_sampleInterval = 60;
+int ErrorCheck::_frame = 0;
+const char* ErrorCheck::_file = "init";
+int ErrorCheck::_line = 0;
+unsigned int ErrorCheck::_errorCount = 0;
+
+void ErrorCheck::init(GLErrorMode::GLErrorModeEnum mode, int sampleInterval) {
+    _sampleInterval = (sampleInterval < 1) ? 1 : sampleInterval;
+    _frame = 0;
+
+    if ((mode < GLErrorMode::eOff) || (mode > GLErrorMode::eSampled)) {
+        mode = GLErrorMode::eOff;
+    }
+
+    if (mode == GLErrorMode::eCallback) {
+#if !defined(EMSCRIPTEN)
+        if (GLEW_KHR_debug || GLEW_VERSION_4_3) {
+            glEnable(GL_DEBUG_OUTPUT);
+            //report in the context of the offending call so the checkpoint tag is accurate
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_LOW, 0, 0, GL_FALSE);
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, 0, GL_FALSE);
+            glDebugMessageCallback(messageCallback, 0);
+        } else
+#endif
+        {
+            LOG_WARNING << "KHR_debug not available, using sampled GL error checks." << endl;
+            mode = GLErrorMode::eSampled;
+        }
+    }
+
+    _mode = mode;
+    LOG_INFO << "GL error mode: " << _mode << " (sample every " << _sampleInterval << " frames)" << endl;
+}
+
+void ErrorCheck::mark(const char* file, int line) {
+    if ((_mode == GLErrorMode::eSampled) && (_frame == 0)) {
+        drain(file, line);
+    }
+    _file = file;
+    _line = line;
+}
+
+void ErrorCheck::drain(const char* file, int line) {
+    GLenum err;
+    while ((err = glGetError()) != GL_NO_ERROR) {
+        _errorCount++;
+        LOG_ERROR << "GL ERROR: " << hex << err << dec << " between " << _file << ":" << _line << " and " << file << ":"
+                  << line << "\n";
+    }
+}
+
+void ErrorCheck::endFrame(void) {
+    if (_mode != GLErrorMode::eSampled) {
+        return;
+    }
+
+    if (_frame == 0) {
+        drain("end of frame", 0);
+    }
+    _frame = (_frame + 1) % _sampleInterval;
+    _file = "start of frame";
+    _line = 0;
+}
+
+void GLAPIENTRY ErrorCheck::messageCallback(GLenum /*source*/, GLenum type, GLuint /*id*/, GLenum severity,
+    GLsizei /*length*/, const GLchar* message, const void* /*userParam*/) {
+    if (type == GL_DEBUG_TYPE_ERROR) {
+        _errorCount++;
+    }
+
+    //errors as errors, questionable use as warnings, the rest (e.g. performance) is informational
+    if ((type == GL_DEBUG_TYPE_ERROR) || (severity == GL_DEBUG_SEVERITY_HIGH)) {
+        LOG_ERROR << "GL: " << message << " - type: " << hex << type << " - severity: " << severity << dec
+                  << " - after " << _file << ":" << _line << "\n";
+    } else if ((type == GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR) || (type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR) ||
+               (severity == GL_DEBUG_SEVERITY_MEDIUM)) {
+        LOG_WARNING << "GL: " << message << " - type: " << hex << type << " - severity: " << severity << dec
+                    << " - after " << _file << ":" << _line << "\n";
+    } else {
+        LOG_INFO << "GL: " << message << " - type: " << hex << type << " - severity: " << severity << dec
+                 << " - after " << _file << ":" << _line << "\n";
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <GL/glew.h>
+
+namespace GLErrorMode {
+enum GLErrorModeEnum {
+    eOff,       //no error queries at all
+    eCallback,  //KHR_debug message callback, no per-frame queries
+    eSampled    //glGetError at checkpoints, every n-th frame only
+};
+}
+
+//GL error reporting. Errors are tagged with the source location of the
+//last GL_CHECKPOINT reached so they can be narrowed down without a sync
+//after every call.
+class ErrorCheck {
+public:
+    //Falls back to eSampled if KHR_debug is not available.
+    static void init(GLErrorMode::GLErrorModeEnum mode, int sampleInterval);
+    static GLErrorMode::GLErrorModeEnum getMode(void) { return _mode; }
+
+    static void checkpoint(const char* file, int line) {
+        if (_mode != GLErrorMode::eOff) {
+            mark(file, line);
+        }
+    }
+
+    //drain pending errors on sampled frames, advance the frame counter
+    static void endFrame(void);
+
+    static unsigned int getErrorCount(void) { return _errorCount; }
+
+private:
+    static void mark(const char* file, int line);
+    static void drain(const char* file, int line);
+
+    static void GLAPIENTRY messageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+        const GLchar* message, const void* userParam);
+
+    static GLErrorMode::GLErrorModeEnum _mode;
+    static int _sampleInterval;
+    static int _frame;
+    static const char* _file;
+    static int _line;
+    static unsigned int _errorCount;
+};
+
+#define GL_CHECKPOINT() ErrorCheck::checkpoint(__FILE__, __LINE__)
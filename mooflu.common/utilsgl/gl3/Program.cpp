@@ -1,6 +1,7 @@
 #include "Program.hpp"
 
 #include "Shader.hpp"
+#include "StateCache.hpp"
 
 #include "Trace.hpp"
 
@@ -20,6 +21,7 @@ Program::~Program() {
         delete shader;
     }
 
+    StateCache::deleteProgram(_id);
     glDeleteProgram(_id);
 }
 
@@ -34,11 +36,11 @@ void Program::use() const {
         return;
     }
 
-    glUseProgram(id());
+    StateCache::useProgram(id());
 }
 
 void Program::release() {
-    glUseProgram(0);
+    StateCache::useProgram(0);
 }
 
 bool Program::isUsed() const {
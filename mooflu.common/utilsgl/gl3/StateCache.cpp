@@ -0,0 +1,187 @@
+#include "StateCache.hpp"
+
+GLuint StateCache::_arrayBuffer = StateCache::UNKNOWN;
+GLuint StateCache::_elementArrayBuffer = StateCache::UNKNOWN;
+GLuint StateCache::_vertexArray = StateCache::UNKNOWN;
+GLuint StateCache::_program = StateCache::UNKNOWN;
+GLuint StateCache::_texture2D = StateCache::UNKNOWN;
+GLuint StateCache::_textureCubeMap = StateCache::UNKNOWN;
+int StateCache::_caps[StateCache::eNumCaps] = {-1, -1, -1, -1};
+GLenum StateCache::_blendSrc = GL_NONE;
+GLenum StateCache::_blendDst = GL_NONE;
+
+StateCache::Counters StateCache::_counters = {0, 0};
+StateCache::Counters StateCache::_frameCounters = {0, 0};
+
+void StateCache::bindBuffer(GLenum target, GLuint id) {
+    GLuint* cached = 0;
+    if (target == GL_ARRAY_BUFFER) {
+        cached = &_arrayBuffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        cached = &_elementArrayBuffer;
+    }
+
+    if (cached && (*cached == id)) {
+        _counters.skipped++;
+        return;
+    }
+
+    glBindBuffer(target, id);
+    _counters.issued++;
+    if (cached) {
+        *cached = id;
+    }
+}
+
+void StateCache::bindVertexArray(GLuint id) {
+    if (_vertexArray == id) {
+        _counters.skipped++;
+        return;
+    }
+
+    glBindVertexArray(id);
+    _counters.issued++;
+    _vertexArray = id;
+
+    //element array binding is part of the VAO
+    _elementArrayBuffer = UNKNOWN;
+}
+
+void StateCache::useProgram(GLuint id) {
+    if (_program == id) {
+        _counters.skipped++;
+        return;
+    }
+
+    glUseProgram(id);
+    _counters.issued++;
+    _program = id;
+}
+
+void StateCache::bindTexture(GLenum target, GLuint id) {
+    GLuint* cached = 0;
+    if (target == GL_TEXTURE_2D) {
+        cached = &_texture2D;
+    } else if (target == GL_TEXTURE_CUBE_MAP) {
+        cached = &_textureCubeMap;
+    }
+
+    if (cached && (*cached == id)) {
+        _counters.skipped++;
+        return;
+    }
+
+    glBindTexture(target, id);
+    _counters.issued++;
+    if (cached) {
+        *cached = id;
+    }
+}
+
+//returns true if the cap needs to be changed
+bool StateCache::setCap(GLenum cap, bool enabled) {
+    int index;
+    switch (cap) {
+        case GL_BLEND:
+            index = eBlend;
+            break;
+        case GL_DEPTH_TEST:
+            index = eDepthTest;
+            break;
+        case GL_CULL_FACE:
+            index = eCullFace;
+            break;
+        case GL_SCISSOR_TEST:
+            index = eScissorTest;
+            break;
+        default:
+            _counters.issued++;
+            return true;
+    }
+
+    if (_caps[index] == (enabled ? 1 : 0)) {
+        _counters.skipped++;
+        return false;
+    }
+
+    _caps[index] = enabled ? 1 : 0;
+    _counters.issued++;
+    return true;
+}
+
+void StateCache::enable(GLenum cap) {
+    if (setCap(cap, true)) {
+        glEnable(cap);
+    }
+}
+
+void StateCache::disable(GLenum cap) {
+    if (setCap(cap, false)) {
+        glDisable(cap);
+    }
+}
+
+void StateCache::blendFunc(GLenum sfactor, GLenum dfactor) {
+    if ((_blendSrc == sfactor) && (_blendDst == dfactor)) {
+        _counters.skipped++;
+        return;
+    }
+
+    glBlendFunc(sfactor, dfactor);
+    _counters.issued++;
+    _blendSrc = sfactor;
+    _blendDst = dfactor;
+}
+
+//A deleted object that is bound reverts to 0 (for a VAO's element array
+//only in that VAO), simply forget what we know.
+void StateCache::deleteBuffer(GLuint id) {
+    if (_arrayBuffer == id) {
+        _arrayBuffer = UNKNOWN;
+    }
+    if (_elementArrayBuffer == id) {
+        _elementArrayBuffer = UNKNOWN;
+    }
+}
+
+void StateCache::deleteVertexArray(GLuint id) {
+    if (_vertexArray == id) {
+        _vertexArray = UNKNOWN;
+        _elementArrayBuffer = UNKNOWN;
+    }
+}
+
+void StateCache::deleteProgram(GLuint id) {
+    if (_program == id) {
+        _program = UNKNOWN;
+    }
+}
+
+void StateCache::deleteTexture(GLuint id) {
+    if (_texture2D == id) {
+        _texture2D = UNKNOWN;
+    }
+    if (_textureCubeMap == id) {
+        _textureCubeMap = UNKNOWN;
+    }
+}
+
+void StateCache::invalidate(void) {
+    _arrayBuffer = UNKNOWN;
+    _elementArrayBuffer = UNKNOWN;
+    _vertexArray = UNKNOWN;
+    _program = UNKNOWN;
+    _texture2D = UNKNOWN;
+    _textureCubeMap = UNKNOWN;
+    for (int i = 0; i < eNumCaps; i++) {
+        _caps[i] = -1;
+    }
+    _blendSrc = GL_NONE;
+    _blendDst = GL_NONE;
+}
+
+void StateCache::endFrame(void) {
+    _frameCounters = _counters;
+    _counters.issued = 0;
+    _counters.skipped = 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <GL/glew.h>
+
+//Shadow copy of frequently changed GL state. Calls that would not change
+//the state are skipped. Anything set behind its back (or a new context)
+//requires invalidate().
+class StateCache {
+public:
+    struct Counters {
+        unsigned int issued;
+        unsigned int skipped;
+    };
+
+    static void bindBuffer(GLenum target, GLuint id);
+    static void bindVertexArray(GLuint id);
+    static void useProgram(GLuint id);
+    static void bindTexture(GLenum target, GLuint id);
+
+    static void enable(GLenum cap);
+    static void disable(GLenum cap);
+    static void blendFunc(GLenum sfactor, GLenum dfactor);
+
+    //object is about to be deleted, forget cached bindings of it
+    static void deleteBuffer(GLuint id);
+    static void deleteVertexArray(GLuint id);
+    static void deleteProgram(GLuint id);
+    static void deleteTexture(GLuint id);
+
+    //forget all cached state
+    static void invalidate(void);
+
+    //latch the counters of the frame just finished
+    static void endFrame(void);
+    static const Counters& getFrameCounters(void) { return _frameCounters; }
+
+private:
+    static bool setCap(GLenum cap, bool enabled);
+
+    static const GLuint UNKNOWN = ~0u;
+
+    enum CachedCaps { eBlend, eDepthTest, eCullFace, eScissorTest, eNumCaps };
+
+    static GLuint _arrayBuffer;
+    static GLuint _elementArrayBuffer;
+    static GLuint _vertexArray;
+    static GLuint _program;
+    static GLuint _texture2D;
+    static GLuint _textureCubeMap;
+    static int _caps[eNumCaps];
+    static GLenum _blendSrc;
+    static GLenum _blendDst;
+
+    static Counters _counters;
+    static Counters _frameCounters;
+};
@@ -1,6 +1,7 @@
 #include "VertexArray.hpp"
 
 #include "Buffer.hpp"
+#include "StateCache.hpp"
 
 VertexArray::VertexArray() :
     _id(0) {
@@ -9,6 +10,7 @@ VertexArray::VertexArray() :
 
 VertexArray::~VertexArray() {
     unbind();
+    StateCache::deleteVertexArray(_id);
     glDeleteVertexArrays(1, &_id);
 }
 
@@ -17,11 +19,11 @@ GLuint VertexArray::id() const {
 }
 
 void VertexArray::bind() const {
-    glBindVertexArray(id());
+    StateCache::bindVertexArray(id());
 }
 
 void VertexArray::unbind() {
-    glBindVertexArray(0);
+    StateCache::bindVertexArray(0);
 }
 
 void VertexArray::bindElementBuffer(const Buffer* buffer) {
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# Bake bitmap collection .data files into the binary .idx format read by
+# GLBitmapCollection::LoadIndexFile. The text .data files remain the source of
+# truth; run this before zipping data/ into resource.dat.
+#
+# usage: bakeBitmapIndex.py [dir ...]   (default: data/bitmaps)
+import glob
+import os
+import re
+import struct
+import sys
+
+MAX_BITMAPS = 512
+NAME_SLOTS = MAX_BITMAPS * 2
+EMPTY_SLOT = 0xffff
+VERSION = 1
+
+lineRE = re.compile(r'^\s*(-?\d+)\s+(-?\d+)\s+(-?\d+)\s+(-?\d+)\s+(-?\d+)\s+(-?\d+)\s*\[?(.*)$')
+
+
+def hashName(name):
+    # FNV-1a, must match GLBitmapCollection::hashName
+    h = 2166136261
+    for c in name:
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+
+def parse(dataFile):
+    bitmaps = []
+    with open(dataFile, 'rb') as f:
+        for line in f.read().split(b'\n'):
+            line = line.rstrip(b'\r')
+            m = lineRE.match(line.decode('latin-1'))
+            if not m:
+                break
+            name = m.group(7).encode('latin-1')
+            if name.endswith(b']'):
+                name = name[:-1]
+            if name == b'':
+                # assume missing element is a space
+                name = b' '
+            if len(bitmaps) >= MAX_BITMAPS:
+                raise SystemExit('%s: more than %d bitmaps' % (dataFile, MAX_BITMAPS))
+            bitmaps.append([int(v) for v in m.groups()[:6]] + [name[:31]])
+    return bitmaps
+
+
+def nameTable(bitmaps):
+    slots = [EMPTY_SLOT] * NAME_SLOTS
+    for i, bm in enumerate(bitmaps):
+        slot = hashName(bm[6]) & (NAME_SLOTS - 1)
+        while slots[slot] != EMPTY_SLOT and bitmaps[slots[slot]][6] != bm[6]:
+            slot = (slot + 1) & (NAME_SLOTS - 1)
+        if slots[slot] == EMPTY_SLOT:
+            slots[slot] = i
+    return slots
+
+
+def bake(dataFile):
+    bitmaps = parse(dataFile)
+    out = struct.pack('<4sIIII', b'BMIX', VERSION, os.path.getsize(dataFile), len(bitmaps), NAME_SLOTS)
+    for bm in bitmaps:
+        out += struct.pack('<6i32s', *bm)
+    out += struct.pack('<%dH' % NAME_SLOTS, *nameTable(bitmaps))
+
+    indexFile = dataFile[:-len('.data')] + '.idx'
+    with open(indexFile, 'wb') as f:
+        f.write(out)
+    print('%s: %d bitmaps -> %s' % (dataFile, len(bitmaps), indexFile))
+
+
+if __name__ == '__main__':
+    dirs = sys.argv[1:] or ['data/bitmaps']
+    for d in dirs:
+        for dataFile in sorted(glob.glob(os.path.join(d, '*.data'))):
+            bake(dataFile)
@@ -45,6 +45,9 @@ case "$(uname -sr)" in
 esac
 
 if [ ! -f resource.dat ]; then
+    python3 scripts/bakeBitmapIndex.py data/bitmaps
+    python3 scripts/cookTextures.py data/bitmaps
+    python3 scripts/cookMeshes.py data/models
     pushd data
     zip -9r ../resource.dat .
     popd
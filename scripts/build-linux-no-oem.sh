@@ -3,6 +3,9 @@
 
 sudo apt install zlib1g-dev libpng-dev libsdl2-dev libsdl2-mixer-dev libsdl2-image-dev libphysfs-dev libglew-dev libbox2d-dev libglm-dev
 
+python3 scripts/bakeBitmapIndex.py data/bitmaps
+python3 scripts/cookTextures.py data/bitmaps
+python3 scripts/cookMeshes.py data/models
 pushd data
 zip -9r ../resource.dat .
 popd
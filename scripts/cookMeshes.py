@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+# Cook .model text files into the binary .mesh format read by Model::loadMesh.
+# Face corners are welded into an indexed mesh and the triangles reordered for
+# the post-transform vertex cache, the same as Model::buildMesh does at load
+# time. All arithmetic is rounded to float in the order the C++ does it, so a
+# cooked mesh is bit for bit what the runtime would build. The text .model
+# files remain the source of truth; run this before zipping data/ into
+# resource.dat.
+#
+# Like Model::load, a name ending in X (fooX.model) is foo.model with normals
+# flipped to face +z; it is cooked to fooX.mesh.
+#
+# usage: cookMeshes.py [dir | file.model ...]   (default: data/models)
+import glob
+import math
+import os
+import struct
+import sys
+
+VERSION = 1
+VERTEX_CACHE_SIZE = 16
+
+
+def f32(v):
+    return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def sourceOf(modelFile):
+    # fooX.model -> (foo.model, fixNormals), see Model::load
+    if modelFile.endswith('X.model'):
+        return modelFile[:-len('X.model')] + '.model', True
+    return modelFile, False
+
+
+def parse(modelFile, fixNormals):
+    model = {'name': b'', 'scale': (1.0, 1.0, 1.0), 'offset': (0.0, 0.0, 0.0),
+             'colors': [], 'verts': [], 'norms': [], 'faces': []}
+    with open(modelFile, 'rb') as f:
+        lines = [l.decode('latin-1').split() for l in f.read().split(b'\n')]
+
+    def section(i, count, width):
+        rows = [[float(v) for v in l] for l in lines[i:i + count]]
+        if len(rows) != count or any(len(r) != width for r in rows):
+            raise SystemExit('%s: bad section at line %d' % (modelFile, i))
+        return rows
+
+    i = 0
+    while i < len(lines):
+        t = lines[i]
+        i += 1
+        if not t or t[0].startswith('#'):
+            continue
+        if t[0] == 'Name':
+            model['name'] = t[1].encode('latin-1')
+        elif t[0] == 'Scale':
+            model['scale'] = tuple(f32(float(v)) for v in t[1:4])
+        elif t[0] == 'Offset':
+            model['offset'] = tuple(float(v) for v in t[1:4])
+        elif t[0] == 'Colors':
+            n = int(t[1])
+            model['colors'] = [tuple(f32(v) for v in r) + (1.0,) for r in section(i, n, 3)]
+            i += n
+        elif t[0] == 'Vertices':
+            n = int(t[1])
+            s = model['scale']
+            model['verts'] = [tuple(f32(f32(r[k]) * s[k]) for k in range(3)) for r in section(i, n, 3)]
+            i += n
+        elif t[0] == 'Normals':
+            n = int(t[1])
+            norms = [tuple(f32(v) for v in r) for r in section(i, n, 3)]
+            if fixNormals:
+                norms = [tuple(-v for v in r) if r[2] < 0 else r for r in norms]
+            model['norms'] = norms
+            i += n
+        elif t[0] == 'Faces':
+            n = int(t[1])
+            model['faces'] = [[int(v) for v in r] for r in section(i, n, 6)]
+            i += n
+        else:
+            raise SystemExit('%s: syntax error [%s] line:%d' % (modelFile, t[0], i))
+    return model
+
+
+def averageNormal(norms):
+    # vec3f sum then vmml normalize(): float adds, 1/length, multiply
+    avg = norms[0]
+    for n in norms[1:]:
+        avg = tuple(f32(avg[k] + n[k]) for k in range(3))
+    sq = 0.0
+    for c in avg:
+        sq = f32(sq + f32(c * c))
+    length = f32(math.sqrt(sq))
+    if length == 0:
+        return avg
+    scale = f32(1.0 / length)
+    return tuple(f32(c * scale) for c in avg)
+
+
+def buildMesh(model):
+    corners = {}
+    verts, norms, colors, indices = [], [], [], []
+    white = (1.0, 1.0, 1.0, 1.0)
+    for v1, v2, v3, v4, smooth, color in model['faces']:
+        rgba = model['colors'][color] if model['colors'] else white
+
+        faceVerts = [v1, v2, v3] + ([v4] if v4 != 0 else [])
+        avg = averageNormal([model['norms'][v] for v in faceVerts])
+
+        # quads are split in two
+        for v in [v1, v2, v3] + ([v3, v4, v1] if v4 != 0 else []):
+            corner = (model['verts'][v], model['norms'][v] if smooth == 1 else avg, rgba)
+            # welded on the float bits like Model.cpp, so 0.0 and -0.0 differ
+            key = struct.pack('<10f', *(corner[0] + corner[1] + corner[2]))
+            if key not in corners:
+                corners[key] = len(verts)
+                verts.append(corner[0])
+                norms.append(corner[1])
+                colors.append(corner[2])
+            indices.append(corners[key])
+    return verts, norms, colors, indices
+
+
+def optimizeVertexCache(indices, numVerts, cacheSize):
+    # Tipsify, must match optimizeVertexCache in Model.cpp
+    numTris = len(indices) // 3
+    if numTris == 0:
+        return indices
+
+    live = [0] * numVerts
+    for v in indices:
+        live[v] += 1
+    adjacency = [[] for _ in range(numVerts)]
+    for t in range(numTris):
+        for c in range(3):
+            adjacency[indices[t * 3 + c]].append(t)
+
+    cacheTime = [0] * numVerts
+    emitted = [False] * numTris
+    deadEnd = []
+    out = []
+
+    fanning = 0
+    stamp = cacheSize + 1
+    cursor = 1
+    while fanning >= 0:
+        candidates = []
+        for t in adjacency[fanning]:
+            if emitted[t]:
+                continue
+            for c in range(3):
+                v = indices[t * 3 + c]
+                out.append(v)
+                deadEnd.append(v)
+                candidates.append(v)
+                live[v] -= 1
+                if stamp - cacheTime[v] > cacheSize:
+                    cacheTime[v] = stamp
+                    stamp += 1
+            emitted[t] = True
+
+        fanning = -1
+        best = -1
+        for v in candidates:
+            if live[v] <= 0:
+                continue
+            priority = 0
+            if stamp - cacheTime[v] + 2 * live[v] <= cacheSize:
+                priority = stamp - cacheTime[v]
+            if priority > best:
+                best = priority
+                fanning = v
+
+        while fanning < 0 and deadEnd:
+            v = deadEnd.pop()
+            if live[v] > 0:
+                fanning = v
+        while fanning < 0 and cursor < numVerts:
+            if live[cursor] > 0:
+                fanning = cursor
+            cursor += 1
+    return out
+
+
+def cook(modelFile):
+    sourceFile, fixNormals = sourceOf(modelFile)
+    model = parse(sourceFile, fixNormals)
+    verts, norms, colors, indices = buildMesh(model)
+    indices = optimizeVertexCache(indices, len(verts), VERTEX_CACHE_SIZE)
+
+    if verts:
+        lo = tuple(min(v[k] for v in model['verts']) for k in range(3))
+        hi = tuple(max(v[k] for v in model['verts']) for k in range(3))
+    else:
+        lo = hi = (0.0, 0.0, 0.0)
+
+    out = struct.pack('<4sIIII', b'MESH', VERSION, os.path.getsize(sourceFile), len(verts), len(indices))
+    out += struct.pack('<9f', *(lo + hi + model['offset']))
+    out += struct.pack('<32s', model['name'][:31])
+    for arr in (verts, norms, colors):
+        for v in arr:
+            out += struct.pack('<%df' % len(v), *v)
+    out += struct.pack('<%dI' % len(indices), *indices)
+
+    meshFile = modelFile[:-len('.model')] + '.mesh'
+    with open(meshFile, 'wb') as f:
+        f.write(out)
+    print('%s: %d faces, %d vertices -> %s' % (modelFile, len(model['faces']), len(verts), meshFile))
+
+
+if __name__ == '__main__':
+    for arg in sys.argv[1:] or ['data/models']:
+        if arg.endswith('.model'):
+            cook(arg)
+            continue
+        for modelFile in sorted(glob.glob(os.path.join(arg, '*.model'))):
+            cook(modelFile)
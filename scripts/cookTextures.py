@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# Cook bitmap collection PNG atlases into DXT5/BC3 compressed KTX textures.
+# GLBitmapCollection loads foo.png as foo.ktx when the GL supports S3TC and
+# falls back to the PNG otherwise.
+#
+# Only the base level is written: in an atlas, lower mip levels would blend
+# neighbouring sprites into each other. Fonts (.font) are left alone, block
+# compression visibly degrades their small glyphs.
+#
+# usage: cookTextures.py [dir ...]   (default: data/bitmaps)
+import glob
+import os
+import struct
+import sys
+import zlib
+
+GL_RGBA = 0x1908
+GL_COMPRESSED_RGBA_S3TC_DXT5_EXT = 0x83F3
+
+KTX_IDENTIFIER = b'\xabKTX 11\xbb\r\n\x1a\n'
+
+
+def readPNG(fileName):
+    # 8 bit RGBA/RGB, non-interlaced only. That's all we ship.
+    with open(fileName, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('%s: not a PNG' % fileName)
+
+    pos = 8
+    idat = b''
+    while pos < len(data):
+        length, chunkType = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        if chunkType == b'IHDR':
+            width, height, depth, colorType, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif chunkType == b'IDAT':
+            idat += chunk
+        pos += 12 + length
+
+    if depth != 8 or colorType not in (2, 6) or interlace != 0:
+        raise ValueError('%s: unsupported PNG format' % fileName)
+
+    bpp = 4 if colorType == 6 else 3
+    stride = width * bpp
+    raw = zlib.decompress(idat)
+    prev = bytearray(stride)
+    rows = []
+    for y in range(height):
+        filterType = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for x in range(stride):
+            a = line[x - bpp] if x >= bpp else 0
+            b = prev[x]
+            c = prev[x - bpp] if x >= bpp else 0
+            if filterType == 1:
+                line[x] = (line[x] + a) & 0xff
+            elif filterType == 2:
+                line[x] = (line[x] + b) & 0xff
+            elif filterType == 3:
+                line[x] = (line[x] + ((a + b) >> 1)) & 0xff
+            elif filterType == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pr = a if (pa <= pb and pa <= pc) else (b if pb <= pc else c)
+                line[x] = (line[x] + pr) & 0xff
+        rows.append(line)
+        prev = line
+
+    pixels = []
+    for line in rows:
+        for x in range(width):
+            o = x * bpp
+            pixels.append((line[o], line[o + 1], line[o + 2], line[o + 3] if bpp == 4 else 255))
+    return width, height, pixels
+
+
+def to565(c):
+    return ((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3)
+
+
+def from565(v):
+    r, g, b = (v >> 11) & 31, (v >> 5) & 63, v & 31
+    return ((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2))
+
+
+def encodeAlpha(block):
+    alphas = [p[3] for p in block]
+    a0, a1 = max(alphas), min(alphas)
+    if a0 == a1:
+        return struct.pack('<BB6s', a0, a1, b'\0' * 6)
+    # 8 alpha mode (a0 > a1)
+    palette = [a0, a1] + [((7 - i) * a0 + i * a1) // 7 for i in range(1, 7)]
+    bits = 0
+    for i, a in enumerate(alphas):
+        best = min(range(8), key=lambda k: abs(palette[k] - a))
+        bits |= best << (3 * i)
+    return struct.pack('<BB', a0, a1) + bits.to_bytes(6, 'little')
+
+
+def encodeColor(block):
+    # bounding box endpoints, inset a little to reduce error
+    opaque = [p for p in block if p[3] > 0] or block
+    lo = [min(p[i] for p in opaque) for i in range(3)]
+    hi = [max(p[i] for p in opaque) for i in range(3)]
+    inset = [(hi[i] - lo[i]) >> 4 for i in range(3)]
+    c0 = to565([min(255, hi[i] - inset[i]) for i in range(3)])
+    c1 = to565([max(0, lo[i] + inset[i]) for i in range(3)])
+    if c0 < c1:
+        c0, c1 = c1, c0
+    if c0 == c1:
+        return struct.pack('<HHI', c0, c1, 0)
+
+    # 4 colour mode (c0 > c1)
+    e0, e1 = from565(c0), from565(c1)
+    palette = [e0, e1,
+               tuple((2 * e0[i] + e1[i]) // 3 for i in range(3)),
+               tuple((e0[i] + 2 * e1[i]) // 3 for i in range(3))]
+    bits = 0
+    for i, p in enumerate(block):
+        best = min(range(4), key=lambda k: (palette[k][0] - p[0]) ** 2 +
+                   (palette[k][1] - p[1]) ** 2 + (palette[k][2] - p[2]) ** 2)
+        bits |= best << (2 * i)
+    return struct.pack('<HHI', c0, c1, bits)
+
+
+def encodeDXT5(width, height, pixels):
+    out = bytearray()
+    for by in range(0, height, 4):
+        for bx in range(0, width, 4):
+            block = [pixels[min(by + y, height - 1) * width + min(bx + x, width - 1)]
+                     for y in range(4) for x in range(4)]
+            out += encodeAlpha(block)
+            out += encodeColor(block)
+    return bytes(out)
+
+
+def cook(fileName, ktxName):
+    width, height, pixels = readPNG(fileName)
+    levels = [encodeDXT5(width, height, pixels)]
+
+    header = KTX_IDENTIFIER + struct.pack('<13I', 0x04030201, 0, 1, 0,
+                                          GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_RGBA,
+                                          width, height, 0, 0, 1, len(levels), 0)
+    with open(ktxName, 'wb') as f:
+        f.write(header)
+        for level in levels:
+            f.write(struct.pack('<I', len(level)))
+            f.write(level)
+    print('%s -> %s' % (fileName, ktxName))
+
+
+if __name__ == '__main__':
+    dirs = sys.argv[1:] or ['data/bitmaps']
+    for d in dirs:
+        for fileName in sorted(glob.glob(os.path.join(d, '*.png'))):
+            cook(fileName, fileName[:-len('.png')] + '.ktx')
+        # fonts used to be cooked too, don't ship stale ones
+        for ktxName in glob.glob(os.path.join(d, '*.font.ktx')):
+            os.remove(ktxName)